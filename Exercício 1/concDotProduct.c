@@ -1,6 +1,8 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
 #include "concGenerics.h"
+#include "vecAlloc.h"
 #include "timer.h"
 
 /**
@@ -42,47 +44,45 @@ void add(void* destVal, const void* elemVal){
 /**
  * @brief Function that computes the dot product between two `float` vectors concurrently.
  * 
+ * @param ctx Context from which the temporaries and the per-thread memory are taken.
  * @param vec1 Base pointer to the 1st vector.
  * @param vec2 Base pointer to the 2nd vector.
  * @param len Length (or dimension) of both vectors.
- * @param nWorkers Number of threads to be used.
+ * @param nWorkers Number of threads to be used (`CONC_AUTO_WORKERS` lets the library choose it).
  * @return Dot product of the two vectors.
+ * 
+ * @note Reusing the same `ctx` across calls avoids allocating memory on each of them.
  */
-float concDotProduct(float* vec1, float* vec2, int len, int nWorkers){
+float concDotProduct(t_conc_ctx* ctx, float* vec1, float* vec2, int len, int nWorkers){
   float (*arrOfPairs)[2]; // Pointer to array of two elements (pair).
   float* prods;           // Vector of products.
-  float dotProd;
+  float dotProd = 0;
 
-  if (!vec1 || !vec2 || len <= 0){
+  if (!ctx || !vec1 || !vec2 || len <= 0){
     printf("ERROR: Invalid argument(s) passed to concDotProduct()!");
     exit(EXIT_FAILURE);
   }
 
-  arrOfPairs = (float(*)[2])calloc(len, sizeof(float[2])); // What a cast! XD
-  if (!arrOfPairs){
-    printf("ERROR: Error in alloccation during the computation of dot product!");
-    exit(EXIT_FAILURE);
-  }
-
-  prods = (float*)calloc(len, sizeof(float));
-  if (!prods){
+  arrOfPairs = (float(*)[2])concCtxAlloc(ctx, len * sizeof(float[2])); // What a cast! XD
+  prods = (float*)concCtxAlloc(ctx, len * sizeof(float));
+  if (!arrOfPairs || !prods){
     printf("ERROR: Error in alloccation during the computation of dot product!");
-    free(arrOfPairs);
+    concCtxReset(ctx);
     exit(EXIT_FAILURE);
   }
 
   // Setting the values in the pairs from both vectors.
-  concMap(arrOfPairs, sizeof(float[2]), vec1, sizeof(float), len, initPairX, nWorkers);
-  concMap(arrOfPairs, sizeof(float[2]), vec2, sizeof(float), len, initPairY, nWorkers);
+  concMapCtx(ctx, arrOfPairs, sizeof(float[2]), vec1, sizeof(float), len, initPairX, nWorkers);
+  concMapCtx(ctx, arrOfPairs, sizeof(float[2]), vec2, sizeof(float), len, initPairY, nWorkers);
 
   // Storing the product of the values in each pair in `prods`.
-  concMap(prods, sizeof(float), arrOfPairs, sizeof(float[2]), len, vecMul, nWorkers);
+  concMapCtx(ctx, prods, sizeof(float), arrOfPairs, sizeof(float[2]), len, vecMul, nWorkers);
 
   // Adding the products together in a single float (the dot product).
-  concReduce(&dotProd, prods, sizeof(float), len, add, nWorkers);
+  concReduceCtx(ctx, &dotProd, prods, sizeof(float), len, add, nWorkers);
 
-  free(arrOfPairs);
-  free(prods);
+  // Releasing the temporaries (kept by the arena for the next call).
+  concCtxReset(ctx);
 
   return dotProd;
 }
@@ -100,10 +100,14 @@ int main(int argc, char* argv[]){
   double begin;
   double end;
   char flagPrint = 0;
+  t_numa_policy policy = VEC_NUMA_FIRST_TOUCH;
+  t_affinity affinity;
+  t_conc_ctx* ctx;
+  t_conc_stats stats;
 
   // Ensuring the arguments to the program are correct.
   if (argc < 3){
-    printf("To few arguments passed to program! Try %s [file_path] [n_threads] [print_vectors? (OPTIONAL)]\n", argv[0]);
+    printf("To few arguments passed to program! Try %s [file_path] [n_threads (0 = auto)] [print_vectors? (OPTIONAL)] [numa_policy (OPTIONAL): 0 = first touch, 1 = interleave] [affinity (OPTIONAL): none, compact, scatter, physical or a CPU list]\n", argv[0]);
     exit(EXIT_FAILURE);
   }
 
@@ -113,6 +117,16 @@ int main(int argc, char* argv[]){
   if (argc > 3)
     flagPrint = atoi(argv[3]);
 
+  if (argc > 4 && atoi(argv[4]))
+    policy = VEC_NUMA_INTERLEAVE;
+
+  // Pinning the workers (before the first touch, so that pages follow them).
+  if (affinityParse(argc > 5 ? argv[5] : "none", &affinity)){
+    printf("ERROR: Invalid affinity policy %s!\n", argv[5]);
+    exit(EXIT_FAILURE);
+  }
+  concSetAffinity(&affinity);
+
   // Opening the file in read-only mode.
   if (!(bin = fopen(fileName, "r"))){
     printf("ERROR: Could not read from binary file!\n");
@@ -126,35 +140,42 @@ int main(int argc, char* argv[]){
     exit(EXIT_FAILURE);
   }
 
-  // Allocating the 1st vector of `float`s according to given `len`.
-  vec1 = (float*)calloc(len, sizeof(float));
+  // Allocating the 1st vector of `float`s according to given `len` (on huge pages).
+  vec1 = (float*)vecAlloc(len * sizeof(float), policy);
   if (!vec1){
     printf("\nERROR: Failure in allocating memory for vector 1!\n");
     exit(EXIT_FAILURE);
   }
 
+  // Placing each page on the node of the thread that will process it, before `fread()` touches them all from here.
+  if (policy == VEC_NUMA_FIRST_TOUCH)
+    concZero(vec1, sizeof(float), len, nWorkers);
+
   // Reading the 1st vector from the binary file.
   if (fread(vec1, sizeof(float), len, bin) != len){
     printf("ERROR: Error in reading the 1st vector from binary!\n");
     fclose(bin);
-    free(vec1);
+    vecFree(vec1, len * sizeof(float));
     exit(EXIT_FAILURE);
   }
 
-  // Allocating the 2nd vector of `float`s according to given `len`.
-  vec2 = (float*)calloc(len, sizeof(float));
+  // Allocating the 2nd vector of `float`s according to given `len` (on huge pages).
+  vec2 = (float*)vecAlloc(len * sizeof(float), policy);
   if (!vec2){
     printf("\nERROR: Failure in allocating memory for vector 2!\n");
-    free(vec1);
+    vecFree(vec1, len * sizeof(float));
     exit(EXIT_FAILURE);
   }
 
+  if (policy == VEC_NUMA_FIRST_TOUCH)
+    concZero(vec2, sizeof(float), len, nWorkers);
+
   // Reading the 2nd vector from the binary file.
   if (fread(vec2, sizeof(float), len, bin) != len){
     printf("ERROR: Error in reading the 2nd vector from binary!\n");
     fclose(bin);
-    free(vec1);
-    free(vec2);
+    vecFree(vec1, len * sizeof(float));
+    vecFree(vec2, len * sizeof(float));
     exit(EXIT_FAILURE);
   }
 
@@ -162,8 +183,8 @@ int main(int argc, char* argv[]){
   if (fread(&seqDotProd, sizeof(float), 1, bin) != 1){
     printf("ERROR: Error in reading the result of sequential dot product from binary!\n");
     fclose(bin);
-    free(vec1);
-    free(vec2);
+    vecFree(vec1, len * sizeof(float));
+    vecFree(vec2, len * sizeof(float));
     exit(EXIT_FAILURE);
   }
 
@@ -178,11 +199,23 @@ int main(int argc, char* argv[]){
     putchar('\n');
   }
 
+  // Creating the context that holds the memory reused by the computation (the arena fits both temporaries, each rounded up to a cache line).
+  ctx = concCtxCreate(nWorkers > 0 ? nWorkers : sysconf(_SC_NPROCESSORS_ONLN), sizeof(float), len * sizeof(float[3]) + 2 * CONC_CACHE_LINE);
+  if (!ctx){
+    printf("ERROR: Could not create the context for the computation!\n");
+    fclose(bin);
+    vecFree(vec1, len * sizeof(float));
+    vecFree(vec2, len * sizeof(float));
+    exit(EXIT_FAILURE);
+  }
+
   // Calculating the dot product concurrently.
   GET_TIME(begin);
-  concDotProd = concDotProduct(vec1, vec2, len, nWorkers);
+  concDotProd = concDotProduct(ctx, vec1, vec2, len, nWorkers);
   GET_TIME(end);
 
+  concCtxStats(ctx, &stats);
+
   // Measuring the error.
   error = (seqDotProd - concDotProd) / seqDotProd;
   if (error < 0)
@@ -193,11 +226,13 @@ int main(int argc, char* argv[]){
   printf("Concurrent result: %f\n", concDotProd);
   printf("Error: %f\n", error);
   printf("Elapsed time to compute dot product: %lf s\n", end-begin);
+  printf("Heap allocations during computation: %ld (in %ld library calls)\n", stats.allocs, stats.calls);
 
   // Freeing memory
+  concCtxDestroy(ctx);
   fclose(bin);
-  free(vec1);
-  free(vec2);
+  vecFree(vec1, len * sizeof(float));
+  vecFree(vec2, len * sizeof(float));
 
   return EXIT_SUCCESS;
 }
\ No newline at end of file
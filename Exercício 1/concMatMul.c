@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <float.h>
+#include "concGenerics.h"
+#include "concGemm.h"
+#include "vecAlloc.h"
+#include "timer.h"
+
+/**
+ * @brief Function that multiplies two matrices the naive way (one dot product per element), for comparison.
+ */
+void naiveMatMul(float* C, const float* A, const float* B, int m, int n, int k){
+  for (int i = 0; i < m; i++)
+    for (int j = 0; j < n; j++){
+      float accum = 0;
+      for (int p = 0; p < k; p++)
+        accum += A[(size_t)i * k + p] * B[(size_t)p * n + j];
+      C[(size_t)i * n + j] = accum;
+    }
+}
+
+/**
+ * @brief Function that computes the plain and the weighted (by `(i+1)*(j+1)`) sums of a matrix, in `double`.
+ */
+void matChecksums(const float* C, int m, int n, double* sum, double* weighted){
+  *sum = *weighted = 0;
+  for (int i = 0; i < m; i++){
+    double row = 0, rowW = 0;
+    for (int j = 0; j < n; j++){
+      row += C[(size_t)i * n + j];
+      rowW += (j + 1.0) * C[(size_t)i * n + j];
+    }
+    *sum += row;
+    *weighted += (i + 1.0) * rowW;
+  }
+}
+
+int main(int argc, char* argv[]){
+  FILE* bin;
+  int m, n, k;
+  size_t sizeA, sizeB, sizeC;
+  float *A, *B, *C;
+  double ref[3]; // Plain sum, weighted sum and error scale of the product, as stored by the generator
+  double sum, weighted, errSum, errWeighted, tolerance;
+  const char* fileName;
+  int nWorkers;
+  double begin, end, gemmTime;
+  char flagPrint = 0, flagNaive = 0;
+  t_affinity affinity;
+
+  if (argc < 3){
+    printf("To few arguments passed to program! Try %s [file_path] [n_threads (0 = auto)] [print_result? (OPTIONAL)] [affinity (OPTIONAL): none, compact, scatter, physical or a CPU list] [compare_with_naive? (OPTIONAL)]\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+
+  fileName = argv[1];
+  nWorkers = atoi(argv[2]);
+
+  if (argc > 3)
+    flagPrint = atoi(argv[3]);
+
+  if (affinityParse(argc > 4 ? argv[4] : "none", &affinity)){
+    printf("ERROR: Invalid affinity policy %s!\n", argv[4]);
+    exit(EXIT_FAILURE);
+  }
+  concSetAffinity(&affinity);
+
+  if (argc > 5)
+    flagNaive = atoi(argv[5]);
+
+  if (!(bin = fopen(fileName, "r"))){
+    printf("ERROR: Could not read from binary file!\n");
+    exit(EXIT_FAILURE);
+  }
+
+  if (fread(&m, sizeof(int), 1, bin) != 1 || fread(&k, sizeof(int), 1, bin) != 1 || fread(&n, sizeof(int), 1, bin) != 1
+      || m <= 0 || k <= 0 || n <= 0){
+    printf("ERROR: Error in reading the dimensions of the matrices from binary file!\n");
+    fclose(bin);
+    exit(EXIT_FAILURE);
+  }
+
+  sizeA = (size_t)m * k * sizeof(float);
+  sizeB = (size_t)k * n * sizeof(float);
+  sizeC = (size_t)m * n * sizeof(float);
+
+  A = (float*)vecAlloc(sizeA, VEC_NUMA_INTERLEAVE);
+  B = (float*)vecAlloc(sizeB, VEC_NUMA_INTERLEAVE);
+  C = (float*)vecAlloc(sizeC, VEC_NUMA_INTERLEAVE);
+  if (!A || !B || !C){
+    printf("\nERROR: Failure in allocating memory for the matrices!\n");
+    fclose(bin);
+    exit(EXIT_FAILURE);
+  }
+
+  if (fread(A, sizeof(float), (size_t)m * k, bin) != (size_t)m * k
+      || fread(B, sizeof(float), (size_t)k * n, bin) != (size_t)k * n
+      || fread(ref, sizeof(double), 3, bin) != 3){
+    printf("ERROR: Error in reading the matrices from binary!\n");
+    fclose(bin);
+    vecFree(A, sizeA);
+    vecFree(B, sizeB);
+    vecFree(C, sizeC);
+    exit(EXIT_FAILURE);
+  }
+  fclose(bin);
+
+  GET_TIME(begin);
+  if (concGemm(C, A, B, m, n, k, nWorkers)){
+    printf("ERROR: Error in the concurrent matrix product!\n");
+    exit(EXIT_FAILURE);
+  }
+  GET_TIME(end);
+  gemmTime = end - begin;
+
+  if (flagPrint){
+    printf("Product:\n");
+    for (int i = 0; i < m; i++){
+      for (int j = 0; j < n; j++)
+        printf(" %f ", C[(size_t)i * n + j]);
+      putchar('\n');
+    }
+  }
+
+  // Rounding errors of a `float` product grow at most like k * epsilon, relative to the sums of |A| * |B|
+  matChecksums(C, m, n, &sum, &weighted);
+  errSum = (sum - ref[0]) / ref[2];
+  errWeighted = (weighted - ref[1]) / (ref[2] * m * n);
+  if (errSum < 0)
+    errSum = -errSum;
+  if (errWeighted < 0)
+    errWeighted = -errWeighted;
+  tolerance = k * FLT_EPSILON;
+
+  printf("Dimensions: %d x %d times %d x %d\n", m, k, k, n);
+  printf("Time elapsed in the concurrent product: %lf s (%.2lf GFLOP/s)\n", gemmTime, 2.0 * m * n * k / gemmTime / 1e9);
+  printf("Relative error of the checksums: %e (plain), %e (weighted), tolerance %e: %s\n",
+         errSum, errWeighted, tolerance, errSum <= tolerance && errWeighted <= tolerance ? "OK" : "MISMATCH");
+
+  if (flagNaive){
+    GET_TIME(begin);
+    naiveMatMul(C, A, B, m, n, k);
+    GET_TIME(end);
+    printf("Time elapsed in the naive product: %lf s (%.2lf GFLOP/s), %.1lfx slower\n",
+           end - begin, 2.0 * m * n * k / (end - begin) / 1e9, (end - begin) / gemmTime);
+  }
+
+  vecFree(A, sizeA);
+  vecFree(B, sizeB);
+  vecFree(C, sizeC);
+
+  return errSum <= tolerance && errWeighted <= tolerance ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,229 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <pthread.h>
+#include "affinity.h"
+
+/**
+ * @brief Structure that describes where a CPU sits in the topology.
+ */
+typedef struct {
+  int cpu;     /**< Index of the CPU (as seen by the kernel). */
+  int package; /**< Physical package (socket) of the CPU. */
+  int core;    /**< Core of the CPU, inside its package. */
+  int coreIdx; /**< Rank of the core among the cores of its package. */
+  int smt;     /**< Rank of the CPU among the hardware threads of its core. */
+} t_cpu_topo;
+
+/**
+ * @brief Auxiliar function that parses a CPU list, like `"0,2,4-7"`.
+ * 
+ * @param list String holding the list.
+ * @param cpus Vector in which the CPUs are to be written (at most `AFF_MAX_CPUS`).
+ * @return Number of CPUs in the list, -1 if it is malformed.
+ */
+static int parseCpuList(const char* list, int* cpus){
+  int nCpus = 0;
+  const char* curr = list;
+  char* end;
+
+  while (*curr && *curr != '\n'){
+    long first = strtol(curr, &end, 10);
+    long last = first;
+
+    if (end == curr || first < 0)
+      return -1;
+    curr = end;
+
+    if (*curr == '-'){
+      last = strtol(curr + 1, &end, 10);
+      if (end == curr + 1 || last < first)
+        return -1;
+      curr = end;
+    }
+
+    for (long cpu = first; cpu <= last && nCpus < AFF_MAX_CPUS; cpu++)
+      cpus[nCpus++] = (int)cpu;
+
+    if (*curr == ',')
+      curr++;
+    else if (*curr && *curr != '\n')
+      return -1;
+  }
+
+  return nCpus;
+}
+
+/**
+ * @brief Auxiliar function that reads an integer from a file of `/sys`.
+ * 
+ * @param path Path of the file.
+ * @param dflt Value returned if the file could not be read.
+ * @return Value read.
+ */
+static int readSysInt(const char* path, int dflt){
+  FILE* file = fopen(path, "r");
+  int val;
+
+  if (!file)
+    return dflt;
+  if (fscanf(file, "%d", &val) != 1)
+    val = dflt;
+  fclose(file);
+
+  return val;
+}
+
+/**
+ * @brief Auxiliar function that reads the topology of every online CPU.
+ * 
+ * @param topo Vector in which the topology is to be written (at most `AFF_MAX_CPUS`).
+ * @return Number of online CPUs, -1 if they could not be read.
+ */
+static int readTopology(t_cpu_topo* topo){
+  char buf[4096];
+  char path[128];
+  int cpus[AFF_MAX_CPUS];
+  int nCpus;
+  FILE* file = fopen("/sys/devices/system/cpu/online", "r");
+
+  if (!file)
+    return -1;
+  if (!fgets(buf, sizeof(buf), file)){
+    fclose(file);
+    return -1;
+  }
+  fclose(file);
+
+  if ((nCpus = parseCpuList(buf, cpus)) <= 0)
+    return -1;
+
+  for (int i = 0; i < nCpus; i++){
+    topo[i].cpu = cpus[i];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpus[i]);
+    topo[i].package = readSysInt(path, 0);
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/core_id", cpus[i]);
+    topo[i].core = readSysInt(path, cpus[i]);
+  }
+
+  // Ranking hardware threads inside their core...
+  for (int i = 0; i < nCpus; i++){
+    topo[i].smt = 0;
+    for (int j = 0; j < i; j++)
+      if (topo[j].package == topo[i].package && topo[j].core == topo[i].core)
+        topo[i].smt++;
+  }
+
+  // ... and cores inside their package (counting each core by its first hardware thread)
+  for (int i = 0; i < nCpus; i++){
+    topo[i].coreIdx = 0;
+    for (int j = 0; j < nCpus; j++)
+      if (topo[j].smt == 0 && topo[j].package == topo[i].package && topo[j].core < topo[i].core)
+        topo[i].coreIdx++;
+  }
+
+  return nCpus;
+}
+
+/**
+ * @brief Auxiliar comparison function for the `AFF_COMPACT` order (package, core, hardware thread).
+ */
+static int cmpCompact(const void* a, const void* b){
+  const t_cpu_topo* x = (const t_cpu_topo*)a;
+  const t_cpu_topo* y = (const t_cpu_topo*)b;
+
+  if (x->package != y->package)
+    return x->package - y->package;
+  if (x->coreIdx != y->coreIdx)
+    return x->coreIdx - y->coreIdx;
+  return x->smt - y->smt;
+}
+
+/**
+ * @brief Auxiliar comparison function for the `AFF_SCATTER` order (hardware thread, core, package).
+ */
+static int cmpScatter(const void* a, const void* b){
+  const t_cpu_topo* x = (const t_cpu_topo*)a;
+  const t_cpu_topo* y = (const t_cpu_topo*)b;
+
+  if (x->smt != y->smt)
+    return x->smt - y->smt;
+  if (x->coreIdx != y->coreIdx)
+    return x->coreIdx - y->coreIdx;
+  return x->package - y->package;
+}
+
+int affinityParse(const char* spec, t_affinity* aff){
+  t_cpu_topo topo[AFF_MAX_CPUS];
+  int nCpus;
+
+  aff->nCpus = 0;
+
+  if (!spec || !strcmp(spec, "none")){
+    aff->policy = AFF_NONE;
+    return 0;
+  }
+
+  if (spec[0] >= '0' && spec[0] <= '9'){
+    aff->policy = AFF_LIST;
+    aff->nCpus = parseCpuList(spec, aff->cpus);
+    return aff->nCpus > 0 ? 0 : -1;
+  }
+
+  if (!strcmp(spec, "compact"))
+    aff->policy = AFF_COMPACT;
+  else if (!strcmp(spec, "scatter"))
+    aff->policy = AFF_SCATTER;
+  else if (!strcmp(spec, "physical"))
+    aff->policy = AFF_PHYSICAL;
+  else
+    return -1;
+
+  if ((nCpus = readTopology(topo)) <= 0)
+    return -1;
+
+  qsort(topo, nCpus, sizeof(t_cpu_topo), aff->policy == AFF_COMPACT ? cmpCompact : cmpScatter);
+
+  for (int i = 0; i < nCpus; i++)
+    if (aff->policy != AFF_PHYSICAL || topo[i].smt == 0)
+      aff->cpus[aff->nCpus++] = topo[i].cpu;
+
+  return 0;
+}
+
+int affinityCpuOf(const t_affinity* aff, int worker){
+  if (!aff || aff->policy == AFF_NONE || aff->nCpus <= 0)
+    return -1;
+  return aff->cpus[worker % aff->nCpus];
+}
+
+pthread_attr_t* affinityAttr(const t_affinity* aff, int worker, pthread_attr_t* attr){
+  int cpu = affinityCpuOf(aff, worker);
+  cpu_set_t set;
+
+  if (cpu < 0 || pthread_attr_init(attr))
+    return NULL;
+
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  if (pthread_attr_setaffinity_np(attr, sizeof(cpu_set_t), &set)){
+    pthread_attr_destroy(attr);
+    return NULL;
+  }
+
+  return attr;
+}
+
+int affinityPinSelf(const t_affinity* aff, int worker){
+  int cpu = affinityCpuOf(aff, worker);
+  cpu_set_t set;
+
+  if (cpu < 0)
+    return 0;
+
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set);
+}
\ No newline at end of file
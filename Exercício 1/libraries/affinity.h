@@ -0,0 +1,82 @@
+/**
+ * @file affinity.h
+ * @brief Library of thread placement functions.
+ * 
+ * Library containing functions that read the CPU topology of the host (from `/sys`) and pin worker threads to CPUs according to a placement policy, so that scaling measurements are stable and reproducible.
+ * 
+ * Worker `i` is always placed on the `i`-th CPU of the order defined by the policy (wrapping around when there are more workers than CPUs).
+ */
+
+#pragma once
+
+#include <pthread.h>
+
+#define AFF_MAX_CPUS 1024 /**< Maximum number of CPUs handled. */
+
+/**
+ * @brief Placement policies of the workers.
+ */
+typedef enum {
+  AFF_NONE,     /**< No pinning: the scheduler is free to migrate the threads. */
+  AFF_COMPACT,  /**< Fills every hardware thread of a core, then the next core of the same socket, then the next socket. */
+  AFF_SCATTER,  /**< Spreads over sockets first, then over cores, using SMT siblings only after every core got a worker. */
+  AFF_PHYSICAL, /**< Same order as `AFF_SCATTER`, but using only one hardware thread per core. */
+  AFF_LIST      /**< Explicit list of CPUs given by the user. */
+} t_aff_policy;
+
+/**
+ * @brief Structure that holds a resolved placement: the order in which CPUs are handed to workers.
+ * 
+ * @sa See affinityParse() for the function that fills this.
+ */
+typedef struct {
+  t_aff_policy policy;    /**< Policy that produced the order. */
+  int nCpus;              /**< Number of CPUs in `cpus`. */
+  int cpus[AFF_MAX_CPUS]; /**< CPU of each worker (worker `i` gets `cpus[i % nCpus]`). */
+} t_affinity;
+
+/**
+ * @brief Function that builds a placement from its textual description.
+ * 
+ * @param spec One of `"none"`, `"compact"`, `"scatter"`, `"physical"` or an explicit CPU list, like `"0,2,4-7"`.
+ * @param aff Pointer to the placement to be filled.
+ * @return 0 in success, -1 if `spec` is invalid or the topology could not be read.
+ */
+int affinityParse(const char* spec, t_affinity* aff);
+
+/**
+ * @brief Function that gives the CPU assigned to a worker.
+ * 
+ * @param aff Pointer to the placement (`NULL` is taken as `AFF_NONE`).
+ * @param worker Index of the worker.
+ * @return CPU of the worker, -1 if it is not to be pinned.
+ */
+int affinityCpuOf(const t_affinity* aff, int worker);
+
+/**
+ * @brief Function that prepares the attributes of a thread so that it is created already pinned.
+ * 
+ * @param aff Pointer to the placement (`NULL` is taken as `AFF_NONE`).
+ * @param worker Index of the worker.
+ * @param attr Pointer to the attributes to be initialized.
+ * @return `attr` if it was initialized (it must be destroyed with `pthread_attr_destroy()` after `pthread_create()`), `NULL` if the worker is not to be pinned (pass it as is to `pthread_create()`).
+ * 
+ * @note Typical use:
+ * ```c
+ * pthread_attr_t attr;
+ * pthread_attr_t* attrPtr = affinityAttr(aff, i, &attr);
+ * pthread_create(&tid, attrPtr, body, args);
+ * if (attrPtr)
+ *   pthread_attr_destroy(attrPtr);
+ * ```
+ */
+pthread_attr_t* affinityAttr(const t_affinity* aff, int worker, pthread_attr_t* attr);
+
+/**
+ * @brief Function that pins the calling thread to the CPU of a worker.
+ * 
+ * @param aff Pointer to the placement (`NULL` is taken as `AFF_NONE`).
+ * @param worker Index of the worker.
+ * @return 0 in success (or nothing to do), error code of `pthread_setaffinity_np()` otherwise.
+ */
+int affinityPinSelf(const t_affinity* aff, int worker);
\ No newline at end of file
@@ -0,0 +1,286 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "exceptions.h"
+#include "affinity.h"
+#include "concGenerics.h"
+#include "concGemm.h"
+
+#if defined(__AVX__)
+#define VLEN 8 /**< Number of `float`s in a vector register (256-bit AVX). */
+#else
+#define VLEN 4 /**< Number of `float`s in a vector register (128-bit SSE/NEON). */
+#endif
+
+#define MR 6            /**< Rows of a micro-tile (with `NR`, 12 vector accumulators: they fit in the 16 vector registers). */
+#define NR (2 * VLEN)   /**< Columns of a micro-tile. */
+#define MC 96           /**< Rows of the packed slice of `A` (multiple of `MR`; `MC` x `KC` floats fit in the L2 cache). */
+#define KC 256          /**< Depth of the packed slices of `A` and `B`. */
+#define NC 2048         /**< Columns of the packed slice of `B` (multiple of `NR`; `KC` x `NC` floats fit in the L3 cache). */
+#define AUTO_FLOPS_PER_WORKER 2e7 /**< Minimum number of floating-point operations given to each thread in auto mode. */
+
+/** @brief Vector of `VLEN` floats (GCC vector extension). */
+typedef float t_vec __attribute__((vector_size(VLEN * sizeof(float))));
+
+/**
+ * @brief Structure that encapsulates the arguments passed to threadGemm().
+ * 
+ * @sa See threadGemm() for the function that uses this.
+ * @sa See concGemm() for the main function of this.
+ */
+typedef struct {
+  float* C;         /**< Base pointer of the result matrix. */
+  const float* A;   /**< Base pointer of the left matrix. */
+  const float* B;   /**< Base pointer of the right matrix. */
+  int n;            /**< Number of columns of `B` and `C`. */
+  int k;            /**< Number of columns of `A` and rows of `B`. */
+  int rowBegin;     /**< First row of the block of `C` of the thread. */
+  int rowEnd;       /**< Row after the last one of the block. */
+  int colBegin;     /**< First column of the block. */
+  int colEnd;       /**< Column after the last one of the block. */
+  float* packA;     /**< Buffer for the packed slice of `A` (`MC` x `KC` floats). */
+  float* packB;     /**< Buffer for the packed slice of `B` (`KC` x `NC` floats). */
+} t_args_gemm;
+
+/**
+ * @brief Auxiliar function that packs an `mc` x `kc` slice of `A` into `MR`-row panels (zero-padded).
+ * 
+ * Inside each panel, the `MR` values of each column are contiguous, in the order the micro-kernel reads them.
+ */
+static void packPanelsA(float* dst, const float* A, int k, int row0, int col0, int mc, int kc){
+  for (int ir = 0; ir < mc; ir += MR){
+    int rows = mc - ir < MR ? mc - ir : MR;
+
+    for (int p = 0; p < kc; p++){
+      for (int r = 0; r < rows; r++)
+        dst[r] = A[(size_t)(row0 + ir + r) * k + col0 + p];
+      for (int r = rows; r < MR; r++)
+        dst[r] = 0;
+      dst += MR;
+    }
+  }
+}
+
+/**
+ * @brief Auxiliar function that packs a `kc` x `nc` slice of `B` into `NR`-column panels (zero-padded).
+ * 
+ * Inside each panel, the `NR` values of each row are contiguous, in the order the micro-kernel reads them.
+ */
+static void packPanelsB(float* dst, const float* B, int n, int row0, int col0, int kc, int nc){
+  for (int jr = 0; jr < nc; jr += NR){
+    int cols = nc - jr < NR ? nc - jr : NR;
+
+    for (int p = 0; p < kc; p++){
+      memcpy(dst, &B[(size_t)(row0 + p) * n + col0 + jr], cols * sizeof(float));
+      memset(dst + cols, 0, (NR - cols) * sizeof(float));
+      dst += NR;
+    }
+  }
+}
+
+/**
+ * @brief Auxiliar function that computes an `MR` x `NR` tile of `C` from an `MR`-row panel of `A` and an `NR`-column panel of `B`.
+ * 
+ * @param kc Depth of the panels.
+ * @param a Packed panel of `A`.
+ * @param b Packed panel of `B` (aligned to a vector).
+ * @param c Pointer to the top-left element of the tile in `C`.
+ * @param ldc Distance, in elements, between consecutive rows of `C`.
+ * @param mr Number of valid rows of the tile (at the bottom edge it may be less than `MR`).
+ * @param nr Number of valid columns of the tile (at the right edge it may be less than `NR`).
+ * @param accumulate Whether the tile is added to `C` (otherwise it overwrites it).
+ */
+static void microKernel(int kc, const float* a, const float* b, float* c, int ldc, int mr, int nr, int accumulate){
+  t_vec acc[MR][2];
+  float tile[MR][NR];
+
+  for (int r = 0; r < MR; r++)
+    acc[r][0] = acc[r][1] = (t_vec){0};
+
+  // Rank-1 updates: one row of the `B` panel (two vectors) times each of the `MR` values of the `A` column
+  for (int p = 0; p < kc; p++){
+    t_vec b0 = *(const t_vec*)(b + p * NR);
+    t_vec b1 = *(const t_vec*)(b + p * NR + VLEN);
+
+    for (int r = 0; r < MR; r++){
+      float ar = a[p * MR + r];
+      acc[r][0] += ar * b0;
+      acc[r][1] += ar * b1;
+    }
+  }
+
+  // Full tiles go straight to `C`; edge tiles go through a temporary first
+  if (mr == MR && nr == NR){
+    for (int r = 0; r < MR; r++){
+      float* row = c + (size_t)r * ldc;
+      t_vec c0, c1;
+
+      if (accumulate){
+        memcpy(&c0, row, sizeof(t_vec));
+        memcpy(&c1, row + VLEN, sizeof(t_vec));
+        acc[r][0] += c0;
+        acc[r][1] += c1;
+      }
+      memcpy(row, &acc[r][0], sizeof(t_vec));
+      memcpy(row + VLEN, &acc[r][1], sizeof(t_vec));
+    }
+    return;
+  }
+
+  memcpy(tile, acc, sizeof(tile));
+  for (int r = 0; r < mr; r++)
+    for (int j = 0; j < nr; j++)
+      c[(size_t)r * ldc + j] = accumulate ? c[(size_t)r * ldc + j] + tile[r][j] : tile[r][j];
+}
+
+/**
+ * @brief Auxiliar function that multiplies the block of `C` of a thread, slice after slice.
+ * 
+ * @param arg Pointer to the arguments of the thread.
+ */
+static void gemmBlock(const t_args_gemm* arg){
+  for (int jc = arg->colBegin; jc < arg->colEnd; jc += NC){
+    int nc = arg->colEnd - jc < NC ? arg->colEnd - jc : NC;
+
+    for (int pc = 0; pc < arg->k; pc += KC){
+      int kc = arg->k - pc < KC ? arg->k - pc : KC;
+
+      packPanelsB(arg->packB, arg->B, arg->n, pc, jc, kc, nc);
+
+      for (int ic = arg->rowBegin; ic < arg->rowEnd; ic += MC){
+        int mc = arg->rowEnd - ic < MC ? arg->rowEnd - ic : MC;
+
+        packPanelsA(arg->packA, arg->A, arg->k, ic, pc, mc, kc);
+
+        for (int jr = 0; jr < nc; jr += NR)
+          for (int ir = 0; ir < mc; ir += MR)
+            microKernel(kc, arg->packA + (size_t)ir * kc, arg->packB + (size_t)jr * kc,
+                        &arg->C[(size_t)(ic + ir) * arg->n + jc + jr], arg->n,
+                        mc - ir < MR ? mc - ir : MR, nc - jr < NR ? nc - jr : NR, pc > 0);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Auxiliar thread function for multiplying a block of the result.
+ * 
+ * @param args Parameter that points to a `t_args_gemm` struct.
+ * @return `NULL` pointer.
+ * 
+ * @sa See concGemm() for the main function of this.
+ */
+static void* threadGemm(void* args){
+  gemmBlock((t_args_gemm*)args);
+
+  pthread_exit(NULL);
+}
+
+/**
+ * @brief Auxiliar function that chooses the grid of threads (`rows` x `cols` = `nWorkers`) whose blocks are closest to square.
+ */
+static void chooseGrid(int m, int n, int nWorkers, int* rows, int* cols){
+  double best = -1;
+
+  for (int pr = 1; pr <= nWorkers; pr++){
+    if (nWorkers % pr)
+      continue;
+
+    // Ratio between the sides of a block, always >= 1
+    double h = (double)m / pr, w = (double)n / (nWorkers / pr);
+    double ratio = h > w ? h / w : w / h;
+
+    if (best < 0 || ratio < best){
+      best = ratio;
+      *rows = pr;
+      *cols = nWorkers / pr;
+    }
+  }
+}
+
+/**
+ * @brief Auxiliar function that returns the `i`-th of `parts` boundaries of `[0, len)`, rounded up to a multiple of `unit`.
+ */
+static int splitPoint(int len, int parts, int i, int unit){
+  long long point = ((long long)len * i / parts + unit - 1) / unit * unit;
+  return point < len ? (int)point : len;
+}
+
+int concGemm(float* C, const float* A, const float* B, int m, int n, int k, int nWorkers){
+  int rows = 1, cols = 1;
+  long long maxWorkers = (long long)((m + MR - 1) / MR) * ((n + NR - 1) / NR); // One micro-tile per thread at least
+
+  checkLength(m);
+  checkLength(n);
+  checkLength(k);
+
+  if (nWorkers == CONC_AUTO_WORKERS){
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    double byWork = 2.0 * m * n * k / AUTO_FLOPS_PER_WORKER;
+
+    nWorkers = byWork < cpus ? (int)byWork : (int)cpus;
+  }
+  if (nWorkers < 1)
+    nWorkers = 1;
+  if (nWorkers > maxWorkers)
+    nWorkers = (int)maxWorkers;
+
+  chooseGrid(m, n, nWorkers, &rows, &cols);
+
+  pthread_t tids[nWorkers];
+  t_args_gemm args[nWorkers];
+  int created = 0, failed = 0;
+
+  // Buffers first: a failure here leaves no thread behind
+  for (int i = 0; i < nWorkers; i++){
+    args[i].packA = (float*)aligned_alloc(64, MC * KC * sizeof(float));
+    args[i].packB = (float*)aligned_alloc(64, (size_t)KC * NC * sizeof(float));
+
+    if (!args[i].packA || !args[i].packB){
+      for (int j = 0; j <= i; j++){
+        free(args[j].packA);
+        free(args[j].packB);
+      }
+      checkMalloc(NULL);
+    }
+
+    // Block (i / cols, i % cols) of the grid, with edges on multiples of the micro-tile
+    args[i].C = C;
+    args[i].A = A;
+    args[i].B = B;
+    args[i].n = n;
+    args[i].k = k;
+    args[i].rowBegin = splitPoint(m, rows, i / cols, MR);
+    args[i].rowEnd = splitPoint(m, rows, i / cols + 1, MR);
+    args[i].colBegin = splitPoint(n, cols, i % cols, NR);
+    args[i].colEnd = splitPoint(n, cols, i % cols + 1, NR);
+  }
+
+  if (nWorkers == 1)
+    gemmBlock(&args[0]);
+  else {
+    for (int i = 0; i < nWorkers && !failed; i++){
+      pthread_attr_t attr;
+      pthread_attr_t* attrPtr = affinityAttr(concGetAffinity(), i, &attr);
+
+      failed = pthread_create(&tids[i], attrPtr, threadGemm, &args[i]);
+      created += !failed;
+      if (attrPtr)
+        pthread_attr_destroy(attrPtr);
+    }
+
+    for (int i = 0; i < created; i++)
+      pthread_join(tids[i], NULL);
+  }
+
+  for (int i = 0; i < nWorkers; i++){
+    free(args[i].packA);
+    free(args[i].packB);
+  }
+
+  checkThreadCreate(failed, NULL);
+
+  return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+/**
+ * @file concGemm.h
+ * @brief Library of concurrent dense matrix multiplication.
+ * 
+ * Library containing a `float` matrix product (GEMM) with the worker model of concGenerics.h: a number of threads given by the caller (or chosen by the library), pinned according to concSetAffinity(), each one working on its own part of the result.
+ * 
+ * The result is split in a 2-D grid of blocks, one per thread (rows and columns are divided so that blocks stay as square as possible). Inside its block, each thread follows the usual cache-blocked scheme: a `KC`-deep slice of `B` is packed into `NR`-column panels that stay in the L3/L2 cache, an `MC`-row slice of `A` is packed into `MR`-row panels that stay in the L2/L1 cache, and a SIMD micro-kernel accumulates each `MR` x `NR` tile of the result in registers, reading both panels sequentially.
+ * 
+ * @note The micro-kernel uses GCC vector extensions: compiling with `-O3 -march=native` (or at least `-mavx2 -mfma`) lets it use the widest vector registers of the host.
+ */
+
+#pragma once
+
+/**
+ * @brief Function that computes the matrix product `C = A * B` concurrently.
+ * 
+ * @param C Base pointer of the `m` x `n` result matrix (row-major).
+ * @param A Base pointer of the `m` x `k` matrix (row-major).
+ * @param B Base pointer of the `k` x `n` matrix (row-major).
+ * @param m Number of rows of `A` and `C`.
+ * @param n Number of columns of `B` and `C`.
+ * @param k Number of columns of `A` and rows of `B`.
+ * @param nWorkers Number of threads to be used.
+ * @return 0 in success, error code otherwise.
+ * 
+ * @note Only `C` is modified by this function (its previous contents are overwritten).
+ * 
+ * @warning If `nWorkers` is equal to `CONC_AUTO_WORKERS` (0), the number of threads is chosen by the library, from the number of floating-point operations and of online CPUs. If it is less than 0, its value is taken as 1.
+ * @warning If `m`, `n` or `k` is less than or equal to 0, the function returns `ERROR_LENGTH`.
+ * @warning `C` must not overlap `A` or `B`.
+ */
+int concGemm(float* C, const float* A, const float* B, int m, int n, int k, int nWorkers);
\ No newline at end of file
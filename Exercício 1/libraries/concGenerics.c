@@ -1,10 +1,30 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include "exceptions.h"
+#include "affinity.h"
 #include "concGenerics.h"
 
+#define CALIB_SAMPLE_LEN 1024       /**< Number of leading elements timed inline to calibrate an unknown callback. */
+#define CALIB_CACHE_LEN 64          /**< Maximum number of callbacks whose calibration is kept in cache. */
+#define AUTO_INLINE_NS 100000.0     /**< Estimated work, in nanoseconds, below which an auto mode call runs inline. */
+#define AUTO_NS_PER_WORKER 50000.0  /**< Minimum estimated work, in nanoseconds, given to each thread in auto mode. */
+#define AUTO_BYTES_PER_WORKER 4096  /**< Minimum amount of bytes given to each thread in auto mode (avoids sharing pages between workers). */
+#define CACHE_LINE CONC_CACHE_LINE  /**< Size, in bytes, of a cache line. */
+#define ZERO_NS_PER_BYTE 0.1        /**< Estimated cost, in nanoseconds, of zeroing a byte (used by concZero() in auto mode). */
+#define BYKEY_NS_PER_ELEM 2.0       /**< Estimated cost, in nanoseconds, of aggregating an element by key (used by concHistogram() and concReduceByKey() in auto mode). */
+#define BYKEY_DENSE_BYTES 262144    /**< Size, in bytes, of the private dense array of a worker above which a hash table (of at most this size) may replace it. */
+#define SEARCH_NS_PER_ELEM 1.0      /**< Estimated cost, in nanoseconds, of testing or comparing an element (used by the search functions in auto mode). */
+#define SEARCH_CHUNK 4096           /**< Number of elements in each chunk claimed by the workers of a search. */
+
+/** @brief Rounds `n` up to a multiple of `CACHE_LINE`. */
+#define roundLine(n) (((n) + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1))
+
 /**
  * @brief Structure that encapsulates the arguments passed to threadEnum().
  * 
@@ -43,8 +63,69 @@ typedef struct {
   int segLen;                       /**< Length of the segment. */
   size_t elemSize;                  /**< Size, in bytes, of each element in the segment. */
   void (*func)(void*, const void*); /**< Reducing function. */
+  void* accum;                      /**< Pointer to where the reduced value of the segment is written. */
 } t_args_reduce;
 
+/**
+ * @brief Structure that encapsulates the arguments passed to threadZero().
+ * 
+ * @sa See threadZero() for the function that uses this.
+ * @sa See concZero() for the main function of this.
+ */
+typedef struct {
+  char* segBase;   /**< Base pointer to the segment. */
+  size_t segBytes; /**< Size, in bytes, of the segment. */
+} t_args_zero;
+
+/**
+ * @brief Union of every argument structure, used to size the argument area of a scratch slot.
+ */
+typedef union {
+  t_args_enum e;   /**< Arguments of threadEnum(). */
+  t_args_map m;    /**< Arguments of threadMap(). */
+  t_args_reduce r; /**< Arguments of threadReduce(). */
+  t_args_zero z;   /**< Arguments of threadZero(). */
+} t_args_any;
+
+/**
+ * @brief Header of a temporary that did not fit in the arena of a context.
+ * 
+ * @sa See concCtxAlloc() for the function that uses this.
+ */
+typedef struct t_overflow {
+  struct t_overflow* next; /**< Next overflowed temporary. */
+} t_overflow;
+
+struct t_conc_ctx {
+  int maxWorkers;        /**< Number of preallocated scratch slots. */
+  size_t scratchSize;    /**< Size, in bytes, of the scratch area of each slot. */
+  size_t slotSize;       /**< Size, in bytes, of each slot (arguments + scratch, multiple of `CACHE_LINE`). */
+  char* slots;           /**< Base pointer of the slots. */
+  char* arena;           /**< Base pointer of the arena. */
+  size_t arenaSize;      /**< Size, in bytes, of the arena. */
+  size_t arenaUsed;      /**< Bytes of the arena handed out since the last reset. */
+  size_t arenaDemand;    /**< Bytes requested since the last reset (including overflowed ones). */
+  t_overflow* overflow;  /**< List of temporaries that did not fit in the arena. */
+  t_conc_stats stats;    /**< Allocation counters. */
+};
+
+/**
+ * @brief Structure that holds the calibrated cost of a callback.
+ * 
+ * @sa See autoNWorkers() for the function that uses this.
+ */
+typedef struct {
+  void (*key)(void*, const void*); /**< Calibrated callback (`NULL` for concEnum()). */
+  double nsPerElem;                /**< Measured cost, in nanoseconds, per element. */
+} t_calib;
+
+static t_calib calibCache[CALIB_CACHE_LEN];                    /**< Cache of calibrated callbacks. */
+static int calibLen = 0;                                       /**< Number of valid entries in `calibCache`. */
+static int calibNext = 0;                                      /**< Entry to be replaced when `calibCache` is full. */
+static pthread_mutex_t calibMutex = PTHREAD_MUTEX_INITIALIZER; /**< Lock that protects `calibCache`. */
+
+static const t_affinity* concAffinity = NULL; /**< Placement of the workers (`NULL` means no pinning). */
+
 /**
  * @brief Auxiliar function that treats inconsistent values for `nWorkers`.
  * 
@@ -62,6 +143,390 @@ static int treatNWorkers(int nWorkers, int vecLen){
   return nWorkers;
 }
 
+void concSetAffinity(const t_affinity* aff){
+  concAffinity = aff;
+}
+
+const t_affinity* concGetAffinity(void){
+  return concAffinity;
+}
+
+/**
+ * @brief Auxiliar function that creates a worker, pinned according to the placement set by concSetAffinity().
+ * 
+ * @param tid Pointer to where the identifier of the thread is to be written.
+ * @param worker Index of the worker.
+ * @param body Thread function.
+ * @param args Arguments of the thread function.
+ * @return Value returned by `pthread_create()`.
+ */
+static int createWorker(pthread_t* tid, int worker, void* (*body)(void*), void* args){
+  pthread_attr_t attr;
+  pthread_attr_t* attrPtr = affinityAttr(concAffinity, worker, &attr);
+  int ret = pthread_create(tid, attrPtr, body, args);
+
+  if (attrPtr)
+    pthread_attr_destroy(attrPtr);
+
+  return ret;
+}
+
+/**
+ * @brief Auxiliar function that creates a group of workers, joining the ones already created if some creation fails.
+ * 
+ * @param tids Vector in which the identifiers of the threads are to be written.
+ * @param nWorkers Number of workers.
+ * @param body Thread function.
+ * @param args Arguments of the first worker.
+ * @param argsStride Distance, in bytes, between the arguments of two consecutive workers (0 if they all share the same).
+ * @return 0 if every worker was created, the value returned by the failed `pthread_create()` otherwise (then no worker is left running, so the arguments may be released).
+ */
+static int createWorkers(pthread_t* tids, int nWorkers, void* (*body)(void*), void* args, size_t argsStride){
+  for (int i = 0; i < nWorkers; i++){
+    int ret = createWorker(&tids[i], i, body, (char*)args + i * argsStride);
+
+    if (ret){
+      for (int j = 0; j < i; j++)
+        pthread_join(tids[j], NULL);
+      return ret;
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Same as createWorkers(), but with the arguments of each worker given by a vector of pointers.
+ * 
+ * @param tids Vector in which the identifiers of the threads are to be written.
+ * @param nWorkers Number of workers.
+ * @param body Thread function.
+ * @param args Vector with the arguments of each worker.
+ * @return 0 if every worker was created, the value returned by the failed `pthread_create()` otherwise (then no worker is left running, so the arguments may be released).
+ */
+static int createWorkerList(pthread_t* tids, int nWorkers, void* (*body)(void*), void** args){
+  for (int i = 0; i < nWorkers; i++){
+    int ret = createWorker(&tids[i], i, body, args[i]);
+
+    if (ret){
+      for (int j = 0; j < i; j++)
+        pthread_join(tids[j], NULL);
+      return ret;
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Auxiliar function that reads a monotonic clock.
+ * 
+ * @return Current time, in nanoseconds.
+ */
+static double nowNs(void){
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/**
+ * @brief Auxiliar function that looks for the calibrated cost of a callback.
+ * 
+ * @param key Callback.
+ * @param nsPerElem Pointer to the variable in which the cost is to be saved, if found.
+ * @return 1 if the callback was already calibrated, 0 otherwise.
+ */
+static int calibLookup(void (*key)(void*, const void*), double* nsPerElem){
+  int found = 0;
+
+  pthread_mutex_lock(&calibMutex);
+  for (int i = 0; i < calibLen && !found; i++){
+    if (calibCache[i].key == key){
+      *nsPerElem = calibCache[i].nsPerElem;
+      found = 1;
+    }
+  }
+  pthread_mutex_unlock(&calibMutex);
+
+  return found;
+}
+
+/**
+ * @brief Auxiliar function that saves the calibrated cost of a callback, replacing the oldest entry if the cache is full.
+ * 
+ * @param key Callback.
+ * @param nsPerElem Measured cost, in nanoseconds, per element.
+ */
+static void calibStore(void (*key)(void*, const void*), double nsPerElem){
+  pthread_mutex_lock(&calibMutex);
+  if (calibLen < CALIB_CACHE_LEN){
+    calibCache[calibLen].key = key;
+    calibCache[calibLen].nsPerElem = nsPerElem;
+    calibLen++;
+  }
+  else {
+    calibCache[calibNext].key = key;
+    calibCache[calibNext].nsPerElem = nsPerElem;
+    calibNext = (calibNext + 1) % CALIB_CACHE_LEN;
+  }
+  pthread_mutex_unlock(&calibMutex);
+}
+
+void concResetCalibration(void){
+  pthread_mutex_lock(&calibMutex);
+  calibLen = 0;
+  calibNext = 0;
+  pthread_mutex_unlock(&calibMutex);
+}
+
+/**
+ * @brief Auxiliar function that chooses the number of threads in auto mode.
+ * 
+ * @param nsPerElem Calibrated cost, in nanoseconds, per element.
+ * @param len Number of elements still to be processed.
+ * @param bytesPerElem Number of bytes touched per element (summing all vectors).
+ * @return Number of threads to be used (1 means running inline).
+ */
+static int autoNWorkers(double nsPerElem, int len, size_t bytesPerElem){
+  double work = nsPerElem * len;
+  long nCpus = sysconf(_SC_NPROCESSORS_ONLN);
+  long maxByBytes = (long)(bytesPerElem * len / AUTO_BYTES_PER_WORKER);
+  long nWorkers;
+
+  if (work < AUTO_INLINE_NS)
+    return 1;
+
+  nWorkers = (long)(work / AUTO_NS_PER_WORKER);
+  if (nWorkers > nCpus)
+    nWorkers = nCpus;
+  if (nWorkers > maxByBytes)
+    nWorkers = maxByBytes;
+
+  return treatNWorkers((int)nWorkers, len);
+}
+
+/**
+ * @brief Auxiliar function that writes an enumeration on a segment of a vector.
+ * 
+ * @param arg Pointer to the description of the segment.
+ */
+static void enumSegment(const t_args_enum* arg){
+  for (int i = arg->idxBase; i < arg->idxBase + arg->segLen; i++)
+    arg->segBase[i] = i;
+}
+
+/**
+ * @brief Auxiliar function that writes the mapped version of the origin segment into the destination segment.
+ * 
+ * @param arg Pointer to the description of the segments.
+ */
+static void mapSegment(const t_args_map* arg){
+  for (char *currOrg = arg->orgSegBase, *currDest = arg->destSegBase;
+       currOrg < arg->orgSegBase + arg->orgElemSize * arg->segLen;
+       currOrg += arg->orgElemSize, currDest += arg->destElemSize)
+    arg->func(currDest, currOrg); // Updating value by reference
+}
+
+/**
+ * @brief Auxiliar function that reduces the elements of a segment onto a single value.
+ * 
+ * @param arg Pointer to the description of the segment.
+ * @param accum Pointer to the accumulator (of, at least, `arg->elemSize` bytes), overwritten with the result.
+ */
+static void reduceSegment(const t_args_reduce* arg, void* accum){
+  memcpy(accum, arg->segBase, arg->elemSize); // Copying the first value to the accumulator
+
+  for (char* curr = arg->segBase + arg->elemSize;
+       curr < arg->segBase + arg->elemSize * arg->segLen;
+       curr += arg->elemSize)
+    arg->func(accum, curr);
+}
+
+/**
+ * @brief Auxiliar function that marks the beginning of a library call made with a context.
+ * 
+ * @param ctx Pointer to the context (may be `NULL`).
+ */
+static void ctxBeginCall(t_conc_ctx* ctx){
+  if (!ctx)
+    return;
+  ctx->stats.calls++;
+  ctx->stats.lastAllocs = 0;
+}
+
+/**
+ * @brief Auxiliar function that allocates memory from the heap, counting it on the context.
+ * 
+ * @param ctx Pointer to the context (may be `NULL`).
+ * @param size Size, in bytes, of the memory.
+ * @return Cache-line-aligned pointer to the memory, `NULL` if allocation failed.
+ */
+static void* ctxHeapAlloc(t_conc_ctx* ctx, size_t size){
+  void* ptr = aligned_alloc(CACHE_LINE, roundLine(size));
+
+  if (ptr && ctx){
+    ctx->stats.allocs++;
+    ctx->stats.lastAllocs++;
+  }
+
+  return ptr;
+}
+
+/**
+ * @brief Auxiliar function that tells whether some memory belongs to the scratch slots of a context.
+ * 
+ * @param ctx Pointer to the context (may be `NULL`).
+ * @param ptr Pointer to the memory.
+ * @return 1 if it does, 0 otherwise.
+ */
+static int inSlots(const t_conc_ctx* ctx, const void* ptr){
+  return ctx && (const char*)ptr >= ctx->slots && (const char*)ptr < ctx->slots + ctx->slotSize * ctx->maxWorkers;
+}
+
+/**
+ * @brief Auxiliar function that gives the memory for the arguments of a worker.
+ * 
+ * @param ctx Pointer to the context (may be `NULL`).
+ * @param worker Index of the worker.
+ * @return Pointer to the memory (from the slot of the worker, when available), `NULL` if allocation failed.
+ */
+static void* workerArgs(t_conc_ctx* ctx, int worker){
+  if (ctx && worker < ctx->maxWorkers)
+    return ctx->slots + worker * ctx->slotSize;
+  return ctxHeapAlloc(ctx, sizeof(t_args_any));
+}
+
+/**
+ * @brief Auxiliar function that gives the scratch memory of a worker.
+ * 
+ * @param ctx Pointer to the context (may be `NULL`).
+ * @param worker Index of the worker.
+ * @param size Size, in bytes, of the scratch needed.
+ * @return Pointer to the memory (from the slot of the worker, when it fits), `NULL` if allocation failed.
+ */
+static void* workerScratch(t_conc_ctx* ctx, int worker, size_t size){
+  if (ctx && worker < ctx->maxWorkers && size <= ctx->scratchSize)
+    return ctx->slots + worker * ctx->slotSize + roundLine(sizeof(t_args_any));
+  return ctxHeapAlloc(ctx, size);
+}
+
+/**
+ * @brief Auxiliar function that gives back memory got from workerArgs() or workerScratch().
+ * 
+ * @param ctx Pointer to the context (may be `NULL`).
+ * @param ptr Pointer to the memory.
+ */
+static void workerRelease(const t_conc_ctx* ctx, void* ptr){
+  if (!inSlots(ctx, ptr))
+    free(ptr);
+}
+
+/**
+ * @brief Auxiliar function that gives back the arguments of a group of workers.
+ * 
+ * @param ctx Pointer to the context (may be `NULL`).
+ * @param args Vector with the arguments of each worker (got from workerArgs()).
+ * @param nWorkers Number of workers.
+ */
+static void releaseArgs(const t_conc_ctx* ctx, void** args, int nWorkers){
+  for (int i = 0; i < nWorkers; i++)
+    workerRelease(ctx, args[i]);
+}
+
+/**
+ * @brief Auxiliar function that gives back the arguments of a group of reducing workers, along with their accumulators.
+ * 
+ * @param ctx Pointer to the context (may be `NULL`).
+ * @param args Vector with the arguments of each worker.
+ * @param nWorkers Number of workers.
+ */
+static void releaseReduceArgs(const t_conc_ctx* ctx, t_args_reduce** args, int nWorkers){
+  for (int i = 0; i < nWorkers; i++){
+    workerRelease(ctx, args[i]->accum);
+    workerRelease(ctx, args[i]);
+  }
+}
+
+t_conc_ctx* concCtxCreate(int maxWorkers, size_t scratchSize, size_t arenaSize){
+  t_conc_ctx* ctx = (t_conc_ctx*)calloc(1, sizeof(t_conc_ctx));
+
+  if (!ctx)
+    return NULL;
+
+  ctx->maxWorkers = maxWorkers > 0 ? maxWorkers : 1;
+  ctx->scratchSize = roundLine(scratchSize);
+  ctx->slotSize = roundLine(sizeof(t_args_any)) + ctx->scratchSize;
+  ctx->slots = (char*)aligned_alloc(CACHE_LINE, ctx->slotSize * ctx->maxWorkers);
+  ctx->arenaSize = roundLine(arenaSize);
+  ctx->arena = ctx->arenaSize ? (char*)aligned_alloc(CACHE_LINE, ctx->arenaSize) : NULL;
+
+  if (!ctx->slots || (ctx->arenaSize && !ctx->arena)){
+    concCtxDestroy(ctx);
+    return NULL;
+  }
+
+  return ctx;
+}
+
+void concCtxDestroy(t_conc_ctx* ctx){
+  if (!ctx)
+    return;
+
+  concCtxReset(ctx);
+  free(ctx->slots);
+  free(ctx->arena);
+  free(ctx);
+}
+
+void* concCtxAlloc(t_conc_ctx* ctx, size_t size){
+  t_overflow* block;
+
+  size = roundLine(size);
+  ctx->arenaDemand += size;
+
+  if (ctx->arenaUsed + size <= ctx->arenaSize){
+    void* ptr = ctx->arena + ctx->arenaUsed;
+    ctx->arenaUsed += size;
+    return ptr;
+  }
+
+  // Not enough room: serving from the heap until the next reset
+  block = (t_overflow*)ctxHeapAlloc(ctx, roundLine(sizeof(t_overflow)) + size);
+  if (!block)
+    return NULL;
+
+  block->next = ctx->overflow;
+  ctx->overflow = block;
+
+  return (char*)block + roundLine(sizeof(t_overflow));
+}
+
+void concCtxReset(t_conc_ctx* ctx){
+  while (ctx->overflow){
+    t_overflow* next = ctx->overflow->next;
+    free(ctx->overflow);
+    ctx->overflow = next;
+  }
+
+  // Growing the arena to the demand seen, so that it fits next time
+  if (ctx->arenaDemand > ctx->arenaSize){
+    char* grown = (char*)ctxHeapAlloc(ctx, ctx->arenaDemand);
+
+    if (grown){
+      free(ctx->arena);
+      ctx->arena = grown;
+      ctx->arenaSize = ctx->arenaDemand;
+    }
+  }
+
+  ctx->arenaUsed = 0;
+  ctx->arenaDemand = 0;
+}
+
+void concCtxStats(const t_conc_ctx* ctx, t_conc_stats* stats){
+  *stats = ctx->stats;
+}
+
 /**
  * @brief Auxiliar thread function for writing an enumeration on a segment of a vector.
  * 
@@ -71,39 +536,79 @@ static int treatNWorkers(int nWorkers, int vecLen){
  * @sa See concEnum() for the main function of this.
  */
 static void* threadEnum(void* args){
-  t_args_enum arg = *(t_args_enum*)args;
-
-  for (int i = arg.idxBase; i < arg.idxBase + arg.segLen; i++)
-    arg.segBase[i] = i;
+  enumSegment((t_args_enum*)args);
 
-  free(args);
-  
   pthread_exit(NULL);
 }
 
-int concEnum(int* dest, int len, int nWorkers){
-  nWorkers = treatNWorkers(nWorkers, len);
-  
+int concEnumCtx(t_conc_ctx* ctx, int* dest, int len, int nWorkers){
+  int done = 0; // Elements already written while calibrating
+
+  checkLength(len);
+  ctxBeginCall(ctx);
+
+  if (nWorkers == CONC_AUTO_WORKERS){
+    double nsPerElem;
+
+    if (!calibLookup(NULL, &nsPerElem)){
+      t_args_enum sample = {dest, 0, len < CALIB_SAMPLE_LEN ? len : CALIB_SAMPLE_LEN};
+      double begin = nowNs();
+
+      enumSegment(&sample);
+      nsPerElem = (nowNs() - begin) / sample.segLen;
+      calibStore(NULL, nsPerElem);
+      done = sample.segLen;
+
+      if (done == len)
+        return EXIT_SUCCESS;
+    }
+
+    nWorkers = autoNWorkers(nsPerElem, len - done, sizeof(int));
+  }
+  else
+    nWorkers = treatNWorkers(nWorkers, len - done);
+
+  if (nWorkers == 1){
+    t_args_enum whole = {dest, done, len - done};
+    enumSegment(&whole);
+    return EXIT_SUCCESS;
+  }
+
   pthread_t tids[nWorkers];
-  t_args_enum* args;
+  t_args_enum* args[nWorkers];
+  int segLen = (len - done) / nWorkers;
+
+  int ret;
 
   for (int i = 0; i < nWorkers; i++){
-    args = (t_args_enum*)malloc(sizeof(t_args_enum));
-    checkMalloc(args);
-    
-    args->idxBase = i * (len / nWorkers);
-    args->segBase = dest;
-    args->segLen = (len / nWorkers) + (i == nWorkers-1 ? (len % nWorkers) : 0);
+    if (!(args[i] = (t_args_enum*)workerArgs(ctx, i))){
+      releaseArgs(ctx, (void**)args, i);
+      checkMalloc(NULL);
+    }
 
-    checkThreadCreate(pthread_create(&tids[i], NULL, threadEnum, args), args);
+    args[i]->idxBase = done + i * segLen;
+    args[i]->segBase = dest;
+    args[i]->segLen = segLen + (i == nWorkers-1 ? ((len - done) % nWorkers) : 0);
   }
 
-  for (int i = 0; i < nWorkers; i++)
+  // Either every worker is created or none is left running
+  if ((ret = createWorkerList(tids, nWorkers, threadEnum, (void**)args))){
+    releaseArgs(ctx, (void**)args, nWorkers);
+    checkThreadCreate(ret, NULL);
+  }
+
+  for (int i = 0; i < nWorkers; i++){
     checkThreadJoin(pthread_join(tids[i], NULL));
+    workerRelease(ctx, args[i]);
+  }
 
   return EXIT_SUCCESS;
 }
 
+int concEnum(int* dest, int len, int nWorkers){
+  return concEnumCtx(NULL, dest, len, nWorkers);
+}
+
 /**
  * @brief Auxiliar thread function for writing the mapped version of the origin segment into the destination segment.
  * 
@@ -113,107 +618,1273 @@ int concEnum(int* dest, int len, int nWorkers){
  * @sa See concMap() for the main function of this.
  */
 static void* threadMap(void* args){
-  t_args_map arg = *(t_args_map*)args;
-
-  for (char *currOrg = arg.orgSegBase, *currDest = arg.destSegBase; 
-       currOrg < arg.orgSegBase + arg.orgElemSize * arg.segLen; 
-       currOrg += arg.orgElemSize, currDest += arg.destElemSize)
-    arg.func(currDest, currOrg); // Updating value by reference
-  
-  free(args);
+  mapSegment((t_args_map*)args);
 
   pthread_exit(NULL);
 }
 
-int concMap(void* dest,
-            size_t destElemSize,
-            void* org,
-            size_t orgElemSize, 
-            int len, 
-            void (*func)(void*, const void*), 
-            int nWorkers){
-  nWorkers = treatNWorkers(nWorkers, len);
-
+int concMapCtx(t_conc_ctx* ctx,
+               void* dest,
+               size_t destElemSize,
+               void* org,
+               size_t orgElemSize,
+               int len,
+               void (*func)(void*, const void*),
+               int nWorkers){
   checkLength(len);
   checkSize(orgElemSize);
   checkSize(destElemSize);
+  ctxBeginCall(ctx);
+
+  if (nWorkers == CONC_AUTO_WORKERS){
+    double nsPerElem;
+
+    if (!calibLookup(func, &nsPerElem)){
+      t_args_map sample = {org, dest, len < CALIB_SAMPLE_LEN ? len : CALIB_SAMPLE_LEN, orgElemSize, destElemSize, func};
+      double begin = nowNs();
+
+      mapSegment(&sample);
+      nsPerElem = (nowNs() - begin) / sample.segLen;
+      calibStore(func, nsPerElem);
+
+      // Skipping the elements already mapped
+      org = (char*)org + orgElemSize * sample.segLen;
+      dest = (char*)dest + destElemSize * sample.segLen;
+      len -= sample.segLen;
+
+      if (!len)
+        return EXIT_SUCCESS;
+    }
+
+    nWorkers = autoNWorkers(nsPerElem, len, orgElemSize + destElemSize);
+  }
+  else
+    nWorkers = treatNWorkers(nWorkers, len);
+
+  if (nWorkers == 1){
+    t_args_map whole = {org, dest, len, orgElemSize, destElemSize, func};
+    mapSegment(&whole);
+    return EXIT_SUCCESS;
+  }
 
   pthread_t tids[nWorkers];
-  t_args_map* args;
+  t_args_map* args[nWorkers];
+
+  int ret;
 
   for (int i = 0; i < nWorkers; i++){
-    args = (t_args_map*)malloc(sizeof(t_args_map));
-    checkMalloc(args);
+    if (!(args[i] = (t_args_map*)workerArgs(ctx, i))){
+      releaseArgs(ctx, (void**)args, i);
+      checkMalloc(NULL);
+    }
 
-    args->orgElemSize = orgElemSize;
-    args->orgSegBase = (char*)org + i * orgElemSize * (len / nWorkers);
-    args->destElemSize = destElemSize;
-    args->destSegBase = (char*)dest + i * destElemSize * (len / nWorkers);
-    args->segLen = (len / nWorkers) + (i == nWorkers-1 ? len % nWorkers : 0);
-    args->func = func;
+    args[i]->orgElemSize = orgElemSize;
+    args[i]->orgSegBase = (char*)org + i * orgElemSize * (len / nWorkers);
+    args[i]->destElemSize = destElemSize;
+    args[i]->destSegBase = (char*)dest + i * destElemSize * (len / nWorkers);
+    args[i]->segLen = (len / nWorkers) + (i == nWorkers-1 ? len % nWorkers : 0);
+    args[i]->func = func;
+  }
 
-    checkThreadCreate(pthread_create(&tids[i], NULL, threadMap, args), args);
+  // Either every worker is created or none is left running
+  if ((ret = createWorkerList(tids, nWorkers, threadMap, (void**)args))){
+    releaseArgs(ctx, (void**)args, nWorkers);
+    checkThreadCreate(ret, NULL);
   }
 
-  for (int i = 0; i < nWorkers; i++)
+  for (int i = 0; i < nWorkers; i++){
     checkThreadJoin(pthread_join(tids[i], NULL));
+    workerRelease(ctx, args[i]);
+  }
 
   return EXIT_SUCCESS;
 }
 
+int concMap(void* dest,
+            size_t destElemSize,
+            void* org,
+            size_t orgElemSize, 
+            int len, 
+            void (*func)(void*, const void*), 
+            int nWorkers){
+  return concMapCtx(NULL, dest, destElemSize, org, orgElemSize, len, func, nWorkers);
+}
+
 /**
  * @brief Auxiliar thread function for reducing the elements of a segment onto a single value.
  * 
  * @param args Parameter that points to a `t_args_reduce` struct.
- * @return Pointer to the reduced value.
+ * @return `NULL` pointer (the reduced value is written on `accum`).
  * 
  * @sa See concReduce() for the main function of this.
  */
 static void* threadReduce(void* args){
-  t_args_reduce arg = *(t_args_reduce*)args;
-  void* accum = malloc(arg.elemSize); // TODO: Defend
+  t_args_reduce* arg = (t_args_reduce*)args;
 
-  memcpy(accum, arg.segBase, arg.elemSize); // Copying the first value to the accumulator
+  reduceSegment(arg, arg->accum);
 
-  for (char* curr = arg.segBase + arg.elemSize;
-       curr < arg.segBase + arg.elemSize * arg.segLen;
-       curr += arg.elemSize)
-    arg.func(accum, curr);
-  
-  pthread_exit(accum);
+  pthread_exit(NULL);
 }
 
-int concReduce(void* dest,
-               void* vec,
-               size_t elemSize,
-               int len,
-               void (*func)(void*, const void*),
-               int nWorkers){
-  nWorkers = treatNWorkers(nWorkers, len);
+int concReduceCtx(t_conc_ctx* ctx,
+                  void* dest,
+                  void* vec,
+                  size_t elemSize,
+                  int len,
+                  void (*func)(void*, const void*),
+                  int nWorkers){
   checkLength(len);
   checkSize(elemSize);
+  ctxBeginCall(ctx);
+
+  if (nWorkers == CONC_AUTO_WORKERS){
+    double nsPerElem;
+
+    if (!calibLookup(func, &nsPerElem)){
+      t_args_reduce sample = {vec, len < CALIB_SAMPLE_LEN ? len : CALIB_SAMPLE_LEN, elemSize, func, NULL};
+      double begin;
+
+      sample.accum = workerScratch(ctx, 0, elemSize);
+      checkMalloc(sample.accum);
+
+      begin = nowNs();
+      reduceSegment(&sample, sample.accum);
+      nsPerElem = (nowNs() - begin) / sample.segLen;
+      calibStore(func, nsPerElem);
+
+      func(dest, sample.accum);
+      workerRelease(ctx, sample.accum);
+
+      // Skipping the elements already reduced
+      vec = (char*)vec + elemSize * sample.segLen;
+      len -= sample.segLen;
+
+      if (!len)
+        return EXIT_SUCCESS;
+    }
+
+    nWorkers = autoNWorkers(nsPerElem, len, elemSize);
+  }
+  else
+    nWorkers = treatNWorkers(nWorkers, len);
+
+  if (nWorkers == 1){
+    t_args_reduce whole = {vec, len, elemSize, func, NULL};
+
+    whole.accum = workerScratch(ctx, 0, elemSize);
+    checkMalloc(whole.accum);
+
+    reduceSegment(&whole, whole.accum);
+    func(dest, whole.accum);
+    workerRelease(ctx, whole.accum);
+
+    return EXIT_SUCCESS;
+  }
 
   pthread_t tids[nWorkers];
-  t_args_reduce* args;
-  void* ret;
-  
+  t_args_reduce* args[nWorkers];
+
+  int ret;
+
   for (int i = 0; i < nWorkers; i++){
-    args = (t_args_reduce*)malloc(sizeof(t_args_reduce));
-    checkMalloc(args);
+    if (!(args[i] = (t_args_reduce*)workerArgs(ctx, i))){
+      releaseReduceArgs(ctx, args, i);
+      checkMalloc(NULL);
+    }
+
+    args[i]->segBase = (char*)vec + i * elemSize * (len / nWorkers);
+    args[i]->segLen = (len / nWorkers) + (i == nWorkers-1 ? len % nWorkers : 0);
+    args[i]->elemSize = elemSize;
+    args[i]->func = func;
 
-    args->segBase = (char*)vec + i * elemSize * (len / nWorkers);
-    args->segLen = (len / nWorkers) + (i == nWorkers-1 ? len % nWorkers : 0);
-    args->elemSize = elemSize;
-    args->func = func;
+    if (!(args[i]->accum = workerScratch(ctx, i, elemSize))){
+      workerRelease(ctx, args[i]);
+      releaseReduceArgs(ctx, args, i);
+      checkMalloc(NULL);
+    }
+  }
 
-    checkThreadCreate(pthread_create(&tids[i], NULL, threadReduce, args), args);
+  // Either every worker is created or none is left running
+  if ((ret = createWorkerList(tids, nWorkers, threadReduce, (void**)args))){
+    releaseReduceArgs(ctx, args, nWorkers);
+    checkThreadCreate(ret, NULL);
   }
 
   for (int i = 0; i < nWorkers; i++){
-    checkThreadJoin(pthread_join(tids[i], &ret));
-    func(dest, ret);
-    free(ret);
+    checkThreadJoin(pthread_join(tids[i], NULL));
+    func(dest, args[i]->accum);
+    workerRelease(ctx, args[i]->accum);
+    workerRelease(ctx, args[i]);
   }
 
   return EXIT_SUCCESS;
+}
+
+int concReduce(void* dest,
+               void* vec,
+               size_t elemSize,
+               int len,
+               void (*func)(void*, const void*),
+               int nWorkers){
+  return concReduceCtx(NULL, dest, vec, elemSize, len, func, nWorkers);
+}
+
+/**
+ * @brief Auxiliar thread function for zeroing a segment of a vector.
+ * 
+ * @param args Parameter that points to a `t_args_zero` struct.
+ * @return `NULL` pointer.
+ * 
+ * @sa See concZero() for the main function of this.
+ */
+static void* threadZero(void* args){
+  t_args_zero* arg = (t_args_zero*)args;
+
+  memset(arg->segBase, 0, arg->segBytes);
+
+  pthread_exit(NULL);
+}
+
+int concZero(void* dest, size_t elemSize, int len, int nWorkers){
+  checkLength(len);
+  checkSize(elemSize);
+
+  if (nWorkers == CONC_AUTO_WORKERS)
+    nWorkers = autoNWorkers(ZERO_NS_PER_BYTE * elemSize, len, elemSize);
+  else
+    nWorkers = treatNWorkers(nWorkers, len);
+
+  if (nWorkers == 1){
+    memset(dest, 0, elemSize * len);
+    return EXIT_SUCCESS;
+  }
+
+  pthread_t tids[nWorkers];
+  t_args_zero args[nWorkers];
+
+  // Same partition as the other functions, so that each worker touches the pages it will later process
+  for (int i = 0; i < nWorkers; i++){
+    args[i].segBase = (char*)dest + i * elemSize * (len / nWorkers);
+    args[i].segBytes = elemSize * ((len / nWorkers) + (i == nWorkers-1 ? len % nWorkers : 0));
+  }
+
+  checkThreadCreate(createWorkers(tids, nWorkers, threadZero, args, sizeof(t_args_zero)), NULL);
+
+  for (int i = 0; i < nWorkers; i++)
+    checkThreadJoin(pthread_join(tids[i], NULL));
+
+  return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Structure that holds what is shared by every worker of concHistogram() and concReduceByKey().
+ * 
+ * @sa See threadByKeyCount() and threadByKeyMerge() for the functions that use this.
+ */
+typedef struct t_bykey {
+  int (*key)(const void*);          /**< Function that gives the key of an element. */
+  void (*func)(void*, const void*); /**< Reducing function (`NULL` when counting). */
+  size_t elemSize;                  /**< Size, in bytes, of each element in the vector. */
+  size_t valSize;                   /**< Size, in bytes, of each value (a `long long` when counting, an element otherwise). */
+  size_t valOffset;                 /**< Offset, in bytes, of the value inside an entry (after its `int` key, keeping the value aligned). */
+  size_t stride;                    /**< Size, in bytes, of each entry. */
+  int nKeys;                        /**< Number of keys. */
+  int nWorkers;                     /**< Number of threads. */
+  int hashBits;                     /**< Base 2 logarithm of the capacity of the hash tables (0 for dense arrays). */
+  char* dest;                       /**< Base pointer of the destination vector. */
+  struct t_args_bykey* workers;     /**< Arguments of every worker (read by the mergers). */
+} t_bykey;
+
+/**
+ * @brief Structure that encapsulates the arguments passed to threadByKeyCount() and threadByKeyMerge().
+ * 
+ * @sa See concHistogram() and concReduceByKey() for the main functions of this.
+ */
+typedef struct t_args_bykey {
+  const t_bykey* shared; /**< Data shared by every worker. */
+  int worker;            /**< Index of the worker. */
+  char* segBase;         /**< Base pointer to the segment. */
+  int segLen;            /**< Length of the segment. */
+  char* priv;            /**< Private values of the worker (dense array or hash table, cache line aligned). */
+  unsigned char* seen;   /**< Whether each private value of a dense array holds something (only when reducing). */
+  char* spill;           /**< Entries of the elements whose key did not fit in the hash table. */
+  char* part;            /**< Entries of the hash table and of `spill`, grouped by the merger that owns their key. */
+  int* partOff;          /**< Offset, in entries, of the group of each merger on `part` (`nWorkers + 1` of them). */
+} t_args_bykey;
+
+/**
+ * @brief Auxiliar function that gives the merger that owns a key.
+ * 
+ * @param b Pointer to the shared data.
+ * @param k Key.
+ * @return Index of the merger (keys are split in contiguous ranges).
+ */
+static int keyOwner(const t_bykey* b, int k){
+  return (int)((long long)k * b->nWorkers / b->nKeys);
+}
+
+/**
+ * @brief Auxiliar function that gives the first key owned by a merger.
+ * 
+ * @param b Pointer to the shared data.
+ * @param m Index of the merger (`nWorkers` gives the end of the last range).
+ * @return Smallest key `k` such that `keyOwner(b, k) >= m`.
+ */
+static int keyBegin(const t_bykey* b, int m){
+  return (int)(((long long)m * b->nKeys + b->nWorkers - 1) / b->nWorkers);
+}
+
+/**
+ * @brief Auxiliar function that folds an element onto a value.
+ * 
+ * @param b Pointer to the shared data.
+ * @param val Pointer to the value.
+ * @param elem Pointer to the element.
+ * @param fresh Whether `val` holds nothing yet.
+ */
+static void foldElem(const t_bykey* b, char* val, const char* elem, int fresh){
+  if (!b->func)
+    *(long long*)val = fresh ? 1 : *(long long*)val + 1;
+  else if (fresh)
+    memcpy(val, elem, b->valSize);
+  else
+    b->func(val, elem);
+}
+
+/**
+ * @brief Auxiliar function that folds a partial value onto the destination vector.
+ * 
+ * @param b Pointer to the shared data.
+ * @param k Key of the value.
+ * @param val Pointer to the partial value.
+ */
+static void foldPartial(const t_bykey* b, int k, const char* val){
+  if (!b->func)
+    ((long long*)b->dest)[k] += *(const long long*)val;
+  else
+    b->func(b->dest + k * b->valSize, val);
+}
+
+/**
+ * @brief Auxiliar function that finds the entry of a key on a hash table, claiming an empty one if it is absent.
+ * 
+ * @param b Pointer to the shared data.
+ * @param table Base pointer of the table (empty entries hold the key -1).
+ * @param k Key.
+ * @param nUsed Pointer to the number of claimed entries of the table.
+ * @param fresh Pointer to where it is written whether the entry was just claimed.
+ * @return Pointer to the value of the entry, `NULL` if the key is absent and the table is already half full.
+ */
+static char* hashSlot(const t_bykey* b, char* table, int k, int* nUsed, int* fresh){
+  size_t mask = ((size_t)1 << b->hashBits) - 1;
+  size_t i = (size_t)(((unsigned long long)(unsigned int)k * 0x9E3779B97F4A7C15ULL) >> (64 - b->hashBits));
+
+  for (;; i = (i + 1) & mask){
+    char* entry = table + i * b->stride;
+    int* entryKey = (int*)entry;
+
+    if (*entryKey == k){
+      *fresh = 0;
+      return entry + b->valOffset;
+    }
+    if (*entryKey == -1){
+      if (*nUsed >= (int)(mask + 1) / 2)
+        return NULL;
+      *entryKey = k;
+      (*nUsed)++;
+      *fresh = 1;
+      return entry + b->valOffset;
+    }
+  }
+}
+
+/**
+ * @brief Auxiliar thread function that aggregates a segment onto the private values of its worker.
+ * 
+ * @param args Parameter that points to a `t_args_bykey` struct.
+ * @return `NULL` pointer.
+ * 
+ * @note The private values are initialized here, so that their pages are placed on the NUMA node of the worker.
+ * 
+ * @note With hash tables, the first keys met fill half of the table and aggregate there; the elements of any other key are spilled as entries of their own. Both are then grouped by the merger that owns their key, so that each merger reads only its own keys.
+ * 
+ * @sa See concHistogram() and concReduceByKey() for the main functions of this.
+ */
+static void* threadByKeyCount(void* args){
+  t_args_bykey* arg = (t_args_bykey*)args;
+  const t_bykey* b = arg->shared;
+  const char* end = arg->segBase + b->elemSize * arg->segLen;
+
+  if (!b->hashBits){
+    if (b->func)
+      memset(arg->seen, 0, b->nKeys);
+    else
+      memset(arg->priv, 0, b->valSize * b->nKeys);
+
+    for (const char* curr = arg->segBase; curr < end; curr += b->elemSize){
+      int k = b->key(curr);
+
+      if (k < 0 || k >= b->nKeys)
+        continue;
+
+      foldElem(b, arg->priv + k * b->valSize, curr, b->func ? !arg->seen[k] : 0);
+      if (b->func)
+        arg->seen[k] = 1;
+    }
+
+    pthread_exit(NULL);
+  }
+
+  size_t capacity = (size_t)1 << b->hashBits;
+  int nUsed = 0;
+  int nSpilled = 0;
+  int next[b->nWorkers];
+
+  for (size_t i = 0; i < capacity; i++)
+    *(int*)(arg->priv + i * b->stride) = -1;
+  memset(arg->partOff, 0, sizeof(int) * (b->nWorkers + 1));
+
+  for (const char* curr = arg->segBase; curr < end; curr += b->elemSize){
+    int k = b->key(curr);
+    int fresh;
+    char* val;
+
+    if (k < 0 || k >= b->nKeys)
+      continue;
+
+    if ((val = hashSlot(b, arg->priv, k, &nUsed, &fresh)) == NULL){
+      char* entry = arg->spill + nSpilled++ * b->stride;
+
+      *(int*)entry = k;
+      val = entry + b->valOffset;
+      fresh = 1;
+    }
+    if (fresh)
+      arg->partOff[keyOwner(b, k) + 1]++;
+
+    foldElem(b, val, curr, fresh);
+  }
+
+  // Counting sort of the entries by merger: the sizes were counted above, then come the offsets and the entries themselves
+  for (int m = 0; m < b->nWorkers; m++)
+    arg->partOff[m+1] += arg->partOff[m];
+  memcpy(next, arg->partOff, sizeof(int) * b->nWorkers);
+
+  for (size_t i = 0; i < capacity && nUsed; i++){
+    char* entry = arg->priv + i * b->stride;
+    int k = *(int*)entry;
+
+    if (k == -1)
+      continue;
+
+    memcpy(arg->part + next[keyOwner(b, k)]++ * b->stride, entry, b->stride);
+    nUsed--;
+  }
+  for (int i = 0; i < nSpilled; i++){
+    char* entry = arg->spill + i * b->stride;
+    memcpy(arg->part + next[keyOwner(b, *(int*)entry)]++ * b->stride, entry, b->stride);
+  }
+
+  pthread_exit(NULL);
+}
+
+/**
+ * @brief Auxiliar thread function that folds the private values of every worker, for the keys owned by a merger, onto the destination vector.
+ * 
+ * @param args Parameter that points to a `t_args_bykey` struct (whose `worker` is the index of the merger).
+ * @return `NULL` pointer.
+ * 
+ * @sa See concHistogram() and concReduceByKey() for the main functions of this.
+ */
+static void* threadByKeyMerge(void* args){
+  t_args_bykey* arg = (t_args_bykey*)args;
+  const t_bykey* b = arg->shared;
+  int m = arg->worker;
+
+  for (int w = 0; w < b->nWorkers; w++){
+    const t_args_bykey* src = &b->workers[w];
+
+    if (!b->hashBits){
+      for (int k = keyBegin(b, m); k < keyBegin(b, m+1); k++)
+        if (!b->func || src->seen[k])
+          foldPartial(b, k, src->priv + k * b->valSize);
+    }
+    else {
+      for (int e = src->partOff[m]; e < src->partOff[m+1]; e++){
+        const char* entry = src->part + e * b->stride;
+        foldPartial(b, *(const int*)entry, entry + b->valOffset);
+      }
+    }
+  }
+
+  pthread_exit(NULL);
+}
+
+/**
+ * @brief Auxiliar function that frees the buffers of the workers of concHistogram() and concReduceByKey().
+ * 
+ * @param args Arguments of the workers (buffers not allocated must be `NULL`).
+ * @param nWorkers Number of workers.
+ */
+static void freeByKey(t_args_bykey* args, int nWorkers){
+  for (int i = 0; i < nWorkers; i++){
+    free(args[i].priv);
+    free(args[i].spill);
+    free(args[i].part);
+    free(args[i].partOff);
+  }
+}
+
+/**
+ * @brief Auxiliar function that runs concHistogram() and concReduceByKey().
+ * 
+ * @param dest Base pointer of the destination vector (of `nKeys` values).
+ * @param nKeys Number of keys.
+ * @param vec Base pointer of the vector.
+ * @param elemSize Size, in bytes, of each element in the vector.
+ * @param len Length of the vector.
+ * @param key Function that gives the key of an element.
+ * @param func Reducing function (`NULL` to count the elements of each key onto `long long` values).
+ * @param nWorkers Number of threads to be used.
+ * @return 0 in success, error code otherwise.
+ */
+static int byKey(void* dest,
+                 int nKeys,
+                 void* vec,
+                 size_t elemSize,
+                 int len,
+                 int (*key)(const void*),
+                 void (*func)(void*, const void*),
+                 int nWorkers){
+  t_bykey b = {key, func, elemSize, func ? elemSize : sizeof(long long), 0, 0, nKeys, 0, 0, (char*)dest, NULL};
+
+  checkLength(len);
+  checkLength(nKeys);
+  checkSize(elemSize);
+
+  if (nWorkers == CONC_AUTO_WORKERS)
+    nWorkers = autoNWorkers(BYKEY_NS_PER_ELEM, len, elemSize);
+  else
+    nWorkers = treatNWorkers(nWorkers, len);
+
+  // A single thread folds straight onto the destination
+  if (nWorkers == 1){
+    for (char* curr = (char*)vec; curr < (char*)vec + elemSize * len; curr += elemSize){
+      int k = key(curr);
+
+      if (k < 0 || k >= nKeys)
+        continue;
+
+      if (func)
+        func(b.dest + k * b.valSize, curr);
+      else
+        ((long long*)dest)[k]++;
+    }
+
+    return EXIT_SUCCESS;
+  }
+
+  t_args_bykey args[nWorkers];
+  pthread_t tids[nWorkers];
+  int maxSegLen = len / nWorkers + len % nWorkers;
+  size_t denseBytes = roundLine(b.valSize * nKeys) + (func ? (size_t)nKeys : 0);
+
+  b.nWorkers = nWorkers;
+  b.workers = args;
+  b.valOffset = b.valSize > sizeof(long long) ? 2 * sizeof(long long) : sizeof(long long);
+  b.stride = (b.valOffset + b.valSize + b.valOffset - 1) / b.valOffset * b.valOffset;
+
+  // Dense arrays too big for the cache are replaced by hash tables that are, as long as the entries of a segment take less memory than them
+  if (denseBytes > BYKEY_DENSE_BYTES && 2 * (size_t)maxSegLen * b.stride < denseBytes){
+    b.hashBits = 1;
+    while (((size_t)2 << b.hashBits) * b.stride <= BYKEY_DENSE_BYTES && ((size_t)1 << b.hashBits) < 2 * (size_t)maxSegLen)
+      b.hashBits++;
+  }
+
+  for (int i = 0; i < nWorkers; i++){
+    args[i].shared = &b;
+    args[i].worker = i;
+    args[i].segBase = (char*)vec + i * elemSize * (len / nWorkers);
+    args[i].segLen = (len / nWorkers) + (i == nWorkers-1 ? len % nWorkers : 0);
+    args[i].priv = NULL;
+    args[i].seen = NULL;
+    args[i].spill = NULL;
+    args[i].part = NULL;
+    args[i].partOff = NULL;
+  }
+
+  // Buffers first: a failure here leaves no thread behind
+  for (int i = 0; i < nWorkers; i++){
+    int ok;
+
+    if (!b.hashBits){
+      args[i].priv = (char*)ctxHeapAlloc(NULL, denseBytes);
+      ok = args[i].priv != NULL;
+      if (ok)
+        args[i].seen = (unsigned char*)args[i].priv + roundLine(b.valSize * nKeys);
+    }
+    else {
+      args[i].priv = (char*)ctxHeapAlloc(NULL, ((size_t)1 << b.hashBits) * b.stride);
+      args[i].spill = (char*)ctxHeapAlloc(NULL, (size_t)args[i].segLen * b.stride);
+      args[i].part = (char*)ctxHeapAlloc(NULL, (size_t)args[i].segLen * b.stride);
+      args[i].partOff = (int*)ctxHeapAlloc(NULL, sizeof(int) * (nWorkers + 1));
+      ok = args[i].priv && args[i].spill && args[i].part && args[i].partOff;
+    }
+
+    if (!ok){
+      freeByKey(args, nWorkers);
+      checkMalloc(NULL);
+    }
+  }
+
+  int createRet = createWorkers(tids, nWorkers, threadByKeyCount, args, sizeof(t_args_bykey));
+  int joinRet = 0;
+
+  if (!createRet){
+    for (int i = 0; i < nWorkers; i++)
+      if (pthread_join(tids[i], NULL))
+        joinRet = 1;
+
+    // Each merger owns a range of keys, so no two threads write on the same value of `dest`
+    if (!joinRet && !(createRet = createWorkers(tids, nWorkers, threadByKeyMerge, args, sizeof(t_args_bykey))))
+      for (int i = 0; i < nWorkers; i++)
+        if (pthread_join(tids[i], NULL))
+          joinRet = 1;
+  }
+
+  // No thread is running by now, whatever failed
+  freeByKey(args, nWorkers);
+
+  checkThreadCreate(createRet, NULL);
+  checkThreadJoin(joinRet);
+
+  return EXIT_SUCCESS;
+}
+
+int concHistogram(long long* bins,
+                  int nBins,
+                  void* vec,
+                  size_t elemSize,
+                  int len,
+                  int (*key)(const void*),
+                  int nWorkers){
+  return byKey(bins, nBins, vec, elemSize, len, key, NULL, nWorkers);
+}
+
+int concReduceByKey(void* dest,
+                    int nKeys,
+                    void* vec,
+                    size_t elemSize,
+                    int len,
+                    int (*key)(const void*),
+                    void (*func)(void*, const void*),
+                    int nWorkers){
+  return byKey(dest, nKeys, vec, elemSize, len, key, func, nWorkers);
+}
+
+/**
+ * @brief Structure that holds what is shared by every worker of concFind(), concAny() and concAll().
+ * 
+ * @sa See threadSearch() for the function that uses this.
+ */
+typedef struct {
+  char* vec;                 /**< Base pointer of the vector. */
+  size_t elemSize;           /**< Size, in bytes, of each element in the vector. */
+  int len;                   /**< Length of the vector. */
+  int (*pred)(const void*);  /**< Predicate searched for. */
+  int negate;                /**< Whether the elements searched for are the ones that do not satisfy `pred` (for concAll()). */
+  int lowest;                /**< Whether the lowest matching index is wanted (concFind()) or any match will do. */
+  atomic_llong next;         /**< Index of the first element of the next chunk to be claimed. */
+  atomic_int limit;          /**< Cancellation flag: index from which no element needs to be tested (`len` while nothing matched). */
+} t_search;
+
+/**
+ * @brief Auxiliar function that lowers the cancellation limit of a search.
+ * 
+ * @param s Pointer to the shared data of the search.
+ * @param idx New limit (ignored if not lower than the current one).
+ */
+static void lowerLimit(t_search* s, int idx){
+  int curr = atomic_load_explicit(&s->limit, memory_order_relaxed);
+
+  while (idx < curr && !atomic_compare_exchange_weak_explicit(&s->limit, &curr, idx, memory_order_relaxed, memory_order_relaxed));
+}
+
+/**
+ * @brief Auxiliar thread function that tests chunks of a vector until the result of the search is determined.
+ * 
+ * @param args Parameter that points to a `t_search` struct.
+ * @return `NULL` pointer (the result is left on `limit`).
+ * 
+ * @note Chunks are claimed in increasing order, so every index below a match was already claimed by some worker, and a worker only stops testing at indexes past the limit. Hence the limit ends at the lowest match.
+ * 
+ * @sa See concFind(), concAny() and concAll() for the main functions of this.
+ */
+static void* threadSearch(void* args){
+  t_search* s = (t_search*)args;
+
+  for (;;){
+    long long begin = atomic_fetch_add_explicit(&s->next, SEARCH_CHUNK, memory_order_relaxed);
+    int end = begin + SEARCH_CHUNK < s->len ? (int)(begin + SEARCH_CHUNK) : s->len;
+
+    if (begin >= atomic_load_explicit(&s->limit, memory_order_relaxed))
+      break;
+
+    for (int i = (int)begin; i < end; i++){
+      if (i >= atomic_load_explicit(&s->limit, memory_order_relaxed))
+        break;
+
+      if (!s->pred(s->vec + i * s->elemSize) != !s->negate){
+        lowerLimit(s, s->lowest ? i : 0);
+        break;
+      }
+    }
+  }
+
+  pthread_exit(NULL);
+}
+
+/**
+ * @brief Auxiliar function that runs concFind(), concAny() and concAll().
+ * 
+ * @param vec Base pointer of the vector.
+ * @param elemSize Size, in bytes, of each element in the vector.
+ * @param len Length of the vector.
+ * @param pred Predicate.
+ * @param negate Whether to search for the elements that do not satisfy `pred`.
+ * @param lowest Whether the lowest matching index is wanted.
+ * @param nWorkers Number of threads to be used.
+ * @param match Pointer to where the result is written: the lowest match if `lowest` (otherwise, some index that is not -1 when there is a match), or -1 if there is none.
+ * @return 0 in success, error code otherwise.
+ */
+static int search(void* vec,
+                  size_t elemSize,
+                  int len,
+                  int (*pred)(const void*),
+                  int negate,
+                  int lowest,
+                  int nWorkers,
+                  int* match){
+  checkLength(len);
+  checkSize(elemSize);
+
+  if (nWorkers == CONC_AUTO_WORKERS)
+    nWorkers = autoNWorkers(SEARCH_NS_PER_ELEM, len, elemSize);
+  else
+    nWorkers = treatNWorkers(nWorkers, len);
+
+  // No more workers than chunks
+  if (nWorkers > (len + SEARCH_CHUNK - 1) / SEARCH_CHUNK)
+    nWorkers = (len + SEARCH_CHUNK - 1) / SEARCH_CHUNK;
+
+  if (nWorkers == 1){
+    *match = -1;
+    for (int i = 0; i < len && *match == -1; i++)
+      if (!pred((char*)vec + i * elemSize) != !negate)
+        *match = i;
+
+    return EXIT_SUCCESS;
+  }
+
+  pthread_t tids[nWorkers];
+  t_search s;
+  int limit;
+
+  s.vec = (char*)vec;
+  s.elemSize = elemSize;
+  s.len = len;
+  s.pred = pred;
+  s.negate = negate;
+  s.lowest = lowest;
+  atomic_init(&s.next, 0);
+  atomic_init(&s.limit, len);
+
+  // Every worker shares `s`: a failed creation joins the ones already running before leaving
+  checkThreadCreate(createWorkers(tids, nWorkers, threadSearch, &s, 0), NULL);
+
+  for (int i = 0; i < nWorkers; i++)
+    checkThreadJoin(pthread_join(tids[i], NULL));
+
+  limit = atomic_load(&s.limit);
+  *match = limit < len ? limit : -1;
+
+  return EXIT_SUCCESS;
+}
+
+int concFind(int* dest, void* vec, size_t elemSize, int len, int (*pred)(const void*), int nWorkers){
+  return search(vec, elemSize, len, pred, 0, 1, nWorkers, dest);
+}
+
+int concAny(int* dest, void* vec, size_t elemSize, int len, int (*pred)(const void*), int nWorkers){
+  int match;
+  int ret = search(vec, elemSize, len, pred, 0, 0, nWorkers, &match);
+
+  if (!ret)
+    *dest = match != -1;
+
+  return ret;
+}
+
+int concAll(int* dest, void* vec, size_t elemSize, int len, int (*pred)(const void*), int nWorkers){
+  int match;
+  int ret = search(vec, elemSize, len, pred, 1, 0, nWorkers, &match);
+
+  if (!ret)
+    *dest = match == -1;
+
+  return ret;
+}
+
+/**
+ * @brief Structure that encapsulates the arguments passed to threadArgExtreme().
+ * 
+ * @sa See threadArgExtreme() for the function that uses this.
+ * @sa See concArgMin() and concArgMax() for the main functions of this.
+ */
+typedef struct {
+  char* vec;                              /**< Base pointer of the vector. */
+  size_t elemSize;                        /**< Size, in bytes, of each element in the vector. */
+  int idxBase;                            /**< Absolute index of the first element of the segment. */
+  int segLen;                             /**< Length of the segment. */
+  int (*cmp)(const void*, const void*);   /**< Comparison function. */
+  int sign;                               /**< 1 for the minimum, -1 for the maximum. */
+  int best;                               /**< Index of the extreme element of the segment (the first one, on ties). */
+} t_args_extreme;
+
+/**
+ * @brief Auxiliar function that tells whether a comparison result puts an element strictly past the current extreme.
+ * 
+ * The result is tested instead of negated, since `-cmp(...)` overflows when `cmp` returns `INT_MIN`.
+ * 
+ * @param sign 1 for the minimum, -1 for the maximum.
+ * @param c Result of the comparison of the element with the current extreme.
+ * @return 1 if the element is the new extreme, 0 otherwise.
+ */
+static int beatsExtreme(int sign, int c){
+  return sign > 0 ? c < 0 : c > 0;
+}
+
+/**
+ * @brief Auxiliar function that finds the extreme element of a segment.
+ * 
+ * @param arg Pointer to the description of the segment (its `best` field is written).
+ */
+static void extremeSegment(t_args_extreme* arg){
+  char* bestVal = arg->vec + arg->idxBase * arg->elemSize;
+
+  arg->best = arg->idxBase;
+  for (int i = arg->idxBase + 1; i < arg->idxBase + arg->segLen; i++){
+    char* curr = arg->vec + i * arg->elemSize;
+
+    if (beatsExtreme(arg->sign, arg->cmp(curr, bestVal))){
+      arg->best = i;
+      bestVal = curr;
+    }
+  }
+}
+
+/**
+ * @brief Auxiliar thread function for finding the extreme element of a segment.
+ * 
+ * @param args Parameter that points to a `t_args_extreme` struct.
+ * @return `NULL` pointer (the index is written on `best`).
+ * 
+ * @sa See concArgMin() and concArgMax() for the main functions of this.
+ */
+static void* threadArgExtreme(void* args){
+  extremeSegment((t_args_extreme*)args);
+
+  pthread_exit(NULL);
+}
+
+/**
+ * @brief Auxiliar function that runs concArgMin() and concArgMax().
+ * 
+ * @param destVal Pointer to where the extreme value is to be copied (may be `NULL`).
+ * @param destIdx Pointer to where its index is to be written (may be `NULL`).
+ * @param vec Base pointer of the vector.
+ * @param elemSize Size, in bytes, of each element in the vector.
+ * @param len Length of the vector.
+ * @param cmp Comparison function.
+ * @param sign 1 for the minimum, -1 for the maximum.
+ * @param nWorkers Number of threads to be used.
+ * @return 0 in success, error code otherwise.
+ */
+static int argExtreme(void* destVal,
+                      int* destIdx,
+                      void* vec,
+                      size_t elemSize,
+                      int len,
+                      int (*cmp)(const void*, const void*),
+                      int sign,
+                      int nWorkers){
+  int best = 0;
+
+  checkLength(len);
+  checkSize(elemSize);
+
+  if (nWorkers == CONC_AUTO_WORKERS)
+    nWorkers = autoNWorkers(SEARCH_NS_PER_ELEM, len, elemSize);
+  else
+    nWorkers = treatNWorkers(nWorkers, len);
+
+  if (nWorkers == 1){
+    t_args_extreme whole = {(char*)vec, elemSize, 0, len, cmp, sign, 0};
+
+    extremeSegment(&whole);
+    best = whole.best;
+  }
+  else {
+    pthread_t tids[nWorkers];
+    t_args_extreme args[nWorkers];
+
+    for (int i = 0; i < nWorkers; i++){
+      args[i].vec = (char*)vec;
+      args[i].elemSize = elemSize;
+      args[i].idxBase = i * (len / nWorkers);
+      args[i].segLen = (len / nWorkers) + (i == nWorkers-1 ? len % nWorkers : 0);
+      args[i].cmp = cmp;
+      args[i].sign = sign;
+    }
+
+    checkThreadCreate(createWorkers(tids, nWorkers, threadArgExtreme, args, sizeof(t_args_extreme)), NULL);
+
+    // Segments are merged in order, so ties keep the lowest index
+    for (int i = 0; i < nWorkers; i++){
+      checkThreadJoin(pthread_join(tids[i], NULL));
+      if (!i || beatsExtreme(sign, cmp((char*)vec + args[i].best * elemSize, (char*)vec + best * elemSize)))
+        best = args[i].best;
+    }
+  }
+
+  if (destVal)
+    memcpy(destVal, (char*)vec + best * elemSize, elemSize);
+  if (destIdx)
+    *destIdx = best;
+
+  return EXIT_SUCCESS;
+}
+
+int concArgMin(void* destVal, int* destIdx, void* vec, size_t elemSize, int len, int (*cmp)(const void*, const void*), int nWorkers){
+  return argExtreme(destVal, destIdx, vec, elemSize, len, cmp, 1, nWorkers);
+}
+
+int concArgMax(void* destVal, int* destIdx, void* vec, size_t elemSize, int len, int (*cmp)(const void*, const void*), int nWorkers){
+  return argExtreme(destVal, destIdx, vec, elemSize, len, cmp, -1, nWorkers);
+}
+
+/**
+ * @brief Structure that encapsulates the arguments passed to threadAsync().
+ * 
+ * @sa See threadAsync() for the function that uses this.
+ * @sa See concMapAsync() and concReduceAsync() for the main functions of this.
+ */
+typedef struct {
+  t_conc_future* future; /**< Future of the operation. */
+  int seg;               /**< Index of the segment handled by the thread. */
+  union {
+    t_args_map m;        /**< Arguments of the segment, if the operation is a map. */
+    t_args_reduce r;     /**< Arguments of the segment, if the operation is a reduction. */
+  };
+} t_args_async;
+
+struct t_conc_future {
+  int nWorkers;                     /**< Number of threads (and segments). */
+  pthread_t* tids;                  /**< Identifiers of the threads. */
+  t_args_async* args;               /**< Arguments of each thread. */
+  int* segBase;                     /**< Index of the first element of each segment. */
+  int* segDone;                     /**< Whether each segment is finished. */
+  int nDone;                        /**< Number of finished segments. */
+  int joined;                       /**< Whether the threads were already joined. */
+  int refs;                         /**< References to this future (the caller's and its dependents'). */
+  pthread_mutex_t mutex;            /**< Lock that protects the fields above. */
+  pthread_cond_t cond;              /**< Signaled whenever a segment finishes. */
+  t_conc_future* after;             /**< Operation this one depends on (may be `NULL`). */
+  int isReduce;                     /**< Whether the operation is a reduction. */
+  void* dest;                       /**< Destination of the reduction. */
+  char* accums;                     /**< Partial results of the reduction (one cache line aligned slot per segment). */
+  size_t accumStride;               /**< Distance, in bytes, between two partial results. */
+  void (*func)(void*, const void*); /**< Reducing function. */
+};
+
+/**
+ * @brief Auxiliar function that blocks until every segment of a future that overlaps a range of elements is finished.
+ * 
+ * @param f Pointer to the future.
+ * @param begin Index of the first element of the range.
+ * @param end Index past the last element of the range.
+ */
+static void waitRange(t_conc_future* f, int begin, int end){
+  pthread_mutex_lock(&f->mutex);
+  for (int i = 0; i < f->nWorkers; i++){
+    int segEnd = i == f->nWorkers-1 ? INT_MAX : f->segBase[i+1];
+
+    if (f->segBase[i] < end && segEnd > begin)
+      while (!f->segDone[i])
+        pthread_cond_wait(&f->cond, &f->mutex);
+  }
+  pthread_mutex_unlock(&f->mutex);
+}
+
+/**
+ * @brief Auxiliar thread function for running one segment of an asynchronous operation.
+ * 
+ * @param args Parameter that points to a `t_args_async` struct.
+ * @return `NULL` pointer.
+ * 
+ * @sa See concMapAsync() and concReduceAsync() for the main functions of this.
+ */
+static void* threadAsync(void* args){
+  t_args_async* arg = (t_args_async*)args;
+  t_conc_future* f = arg->future;
+  int segLen = arg->future->isReduce ? arg->r.segLen : arg->m.segLen;
+
+  // Waiting only for the part of the input this segment reads
+  if (f->after)
+    waitRange(f->after, f->segBase[arg->seg], f->segBase[arg->seg] + segLen);
+
+  if (f->isReduce)
+    reduceSegment(&arg->r, arg->r.accum);
+  else
+    mapSegment(&arg->m);
+
+  pthread_mutex_lock(&f->mutex);
+  f->segDone[arg->seg] = 1;
+  f->nDone++;
+
+  // The last segment to finish folds the partial results, in order, into the destination
+  if (f->isReduce && f->nDone == f->nWorkers)
+    for (int i = 0; i < f->nWorkers; i++)
+      f->func(f->dest, f->accums + i * f->accumStride);
+
+  pthread_cond_broadcast(&f->cond);
+  pthread_mutex_unlock(&f->mutex);
+
+  pthread_exit(NULL);
+}
+
+/**
+ * @brief Auxiliar function that frees the memory of a future (its threads must be already joined).
+ * 
+ * @param f Pointer to the future.
+ */
+static void freeFuture(t_conc_future* f){
+  pthread_mutex_destroy(&f->mutex);
+  pthread_cond_destroy(&f->cond);
+  free(f->tids);
+  free(f->args);
+  free(f->segBase);
+  free(f->segDone);
+  free(f->accums);
+  free(f);
+}
+
+/**
+ * @brief Auxiliar function that drops a reference to a future, freeing it on the last one.
+ * 
+ * @param f Pointer to the future.
+ */
+static void releaseFuture(t_conc_future* f){
+  int refs;
+
+  pthread_mutex_lock(&f->mutex);
+  refs = --f->refs;
+  pthread_mutex_unlock(&f->mutex);
+
+  if (!refs){
+    t_conc_future* after = f->after;
+    freeFuture(f);
+    if (after)
+      releaseFuture(after);
+  }
+}
+
+/**
+ * @brief Auxiliar function that chooses the number of threads of an asynchronous operation.
+ * 
+ * @param nWorkers Number of threads requested.
+ * @param func Callback of the operation.
+ * @param len Length of the vector.
+ * @param bytesPerElem Number of bytes touched per element.
+ * @return Number of threads to be used.
+ * 
+ * @note In auto mode, an uncalibrated callback is not timed (that would block the caller): all online CPUs are used instead.
+ */
+static int asyncNWorkers(int nWorkers, void (*func)(void*, const void*), int len, size_t bytesPerElem){
+  double nsPerElem;
+
+  if (nWorkers != CONC_AUTO_WORKERS)
+    return treatNWorkers(nWorkers, len);
+  if (calibLookup(func, &nsPerElem))
+    return autoNWorkers(nsPerElem, len, bytesPerElem);
+  return treatNWorkers((int)sysconf(_SC_NPROCESSORS_ONLN), len);
+}
+
+/**
+ * @brief Auxiliar function that launches the threads of a future.
+ * 
+ * @param f Pointer to the future, with `nWorkers`, `after` and the reduction fields already set, and every segment described in `args`.
+ * @return `f` in success, `NULL` otherwise (`f` is freed).
+ */
+static t_conc_future* launchFuture(t_conc_future* f){
+  int created = 0;
+
+  f->refs = 1;
+
+  if (f->after){
+    pthread_mutex_lock(&f->after->mutex);
+    f->after->refs++;
+    pthread_mutex_unlock(&f->after->mutex);
+  }
+
+  for (; created < f->nWorkers; created++)
+    if (createWorker(&f->tids[created], created, threadAsync, &f->args[created]))
+      break;
+
+  if (created < f->nWorkers){
+    printError("Cannot create thread!");
+    for (int i = 0; i < created; i++)
+      pthread_join(f->tids[i], NULL);
+    f->joined = 1;
+    releaseFuture(f);
+    return NULL;
+  }
+
+  return f;
+}
+
+/**
+ * @brief Auxiliar function that allocates a future and the per-segment arrays of it, and initializes its lock.
+ * 
+ * @param nWorkers Number of threads (and segments).
+ * @param after Operation the new one depends on (may be `NULL`).
+ * @return Pointer to the future, `NULL` if allocation failed.
+ */
+static t_conc_future* allocFuture(int nWorkers, t_conc_future* after){
+  t_conc_future* f = (t_conc_future*)calloc(1, sizeof(t_conc_future));
+
+  if (!f)
+    return NULL;
+
+  f->nWorkers = nWorkers;
+  f->after = after;
+  f->tids = (pthread_t*)malloc(nWorkers * sizeof(pthread_t));
+  f->args = (t_args_async*)calloc(nWorkers, sizeof(t_args_async));
+  f->segBase = (int*)malloc(nWorkers * sizeof(int));
+  f->segDone = (int*)calloc(nWorkers, sizeof(int));
+
+  if (!f->tids || !f->args || !f->segBase || !f->segDone){
+    free(f->tids);
+    free(f->args);
+    free(f->segBase);
+    free(f->segDone);
+    free(f);
+    return NULL;
+  }
+
+  pthread_mutex_init(&f->mutex, NULL);
+  pthread_cond_init(&f->cond, NULL);
+
+  return f;
+}
+
+t_conc_future* concMapAsync(t_conc_future* after,
+                            void* dest,
+                            size_t destElemSize,
+                            void* org,
+                            size_t orgElemSize,
+                            int len,
+                            void (*func)(void*, const void*),
+                            int nWorkers){
+  t_conc_future* f;
+
+  if (len <= 0 || !orgElemSize || !destElemSize)
+    return NULL;
+
+  nWorkers = asyncNWorkers(nWorkers, func, len, orgElemSize + destElemSize);
+  if (!(f = allocFuture(nWorkers, after)))
+    return NULL;
+
+  for (int i = 0; i < nWorkers; i++){
+    f->segBase[i] = i * (len / nWorkers);
+    f->args[i].future = f;
+    f->args[i].seg = i;
+    f->args[i].m.orgElemSize = orgElemSize;
+    f->args[i].m.orgSegBase = (char*)org + orgElemSize * f->segBase[i];
+    f->args[i].m.destElemSize = destElemSize;
+    f->args[i].m.destSegBase = (char*)dest + destElemSize * f->segBase[i];
+    f->args[i].m.segLen = (len / nWorkers) + (i == nWorkers-1 ? len % nWorkers : 0);
+    f->args[i].m.func = func;
+  }
+
+  return launchFuture(f);
+}
+
+t_conc_future* concReduceAsync(t_conc_future* after,
+                               void* dest,
+                               void* vec,
+                               size_t elemSize,
+                               int len,
+                               void (*func)(void*, const void*),
+                               int nWorkers){
+  t_conc_future* f;
+
+  if (len <= 0 || !elemSize)
+    return NULL;
+
+  nWorkers = asyncNWorkers(nWorkers, func, len, elemSize);
+  if (!(f = allocFuture(nWorkers, after)))
+    return NULL;
+
+  f->isReduce = 1;
+  f->dest = dest;
+  f->func = func;
+  f->accumStride = roundLine(elemSize);
+  f->accums = (char*)aligned_alloc(CACHE_LINE, f->accumStride * nWorkers);
+  if (!f->accums){
+    freeFuture(f);
+    return NULL;
+  }
+
+  for (int i = 0; i < nWorkers; i++){
+    f->segBase[i] = i * (len / nWorkers);
+    f->args[i].future = f;
+    f->args[i].seg = i;
+    f->args[i].r.segBase = (char*)vec + elemSize * f->segBase[i];
+    f->args[i].r.segLen = (len / nWorkers) + (i == nWorkers-1 ? len % nWorkers : 0);
+    f->args[i].r.elemSize = elemSize;
+    f->args[i].r.func = func;
+    f->args[i].r.accum = f->accums + i * f->accumStride;
+  }
+
+  return launchFuture(f);
+}
+
+int concTest(t_conc_future* f){
+  int done;
+
+  pthread_mutex_lock(&f->mutex);
+  done = f->nDone == f->nWorkers;
+  pthread_mutex_unlock(&f->mutex);
+
+  return done;
+}
+
+int concWait(t_conc_future* f){
+  if (f->joined)
+    return EXIT_SUCCESS;
+
+  for (int i = 0; i < f->nWorkers; i++)
+    checkThreadJoin(pthread_join(f->tids[i], NULL));
+  f->joined = 1;
+
+  return EXIT_SUCCESS;
+}
+
+void concFutureDestroy(t_conc_future* f){
+  if (!f)
+    return;
+
+  concWait(f);
+  releaseFuture(f);
 }
\ No newline at end of file
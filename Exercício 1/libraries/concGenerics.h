@@ -8,6 +8,23 @@
 
 #pragma once
 
+#include <stddef.h>
+#include "affinity.h"
+
+/**
+ * @brief Value of `nWorkers` that lets the library choose the number of threads by itself.
+ * 
+ * In this mode, the number of threads is derived from the length of the vector, the size of its elements and the calibrated cost, per element, of the callback. Calls whose estimated work is too small to pay for the creation of threads run inline, on the calling thread.
+ * 
+ * @note The cost of each callback is measured once, by timing the first elements of the first auto mode call that uses it, and then cached for the following calls.
+ */
+#define CONC_AUTO_WORKERS 0
+
+/**
+ * @brief Size, in bytes, of a cache line, to which every temporary of concCtxAlloc() is aligned and rounded up.
+ */
+#define CONC_CACHE_LINE 64
+
 /**
  * @brief Function that sets an enumeration, starting from 0, on a given `int` vector.
  * 
@@ -16,7 +33,7 @@
  * @param nWorkers Number of threads to be used.
  * @return 0 in success, error code otherwise.
  * 
- * @warning If `nWorkers` is less than or equal to 0, its value is taken as 1. If it is greater than the number of elements in the vector, then it is capped by the provided length of the vector.
+ * @warning If `nWorkers` is equal to `CONC_AUTO_WORKERS` (0), the number of threads is chosen by the library. If it is less than 0, its value is taken as 1. If it is greater than the number of elements in the vector, then it is capped by the provided length of the vector.
  * @warning If `len` is less than or equal to 0, the function returns `ERROR_LENGTH`.
  */
 int concEnum(int* dest, int len, int nWorkers);
@@ -32,7 +49,7 @@ int concEnum(int* dest, int len, int nWorkers);
  * @param func Mapping function.
  * @param nWorkers Number of threads to be used.
  * @return 0 in success, error code otherwise.
- *
+ * 
  * @note The mapping function `func`, with signature `func(void* modVal, const void* baseVal)`, receives a value from the original vector (`baseVal`), as its first argument, and sets the mapped version on the memory address pointed by the second argument (`modVal`). An example of mapping function in this style, that receives an `int` and yields its incremented value as an `int`, would be: 
  * ```c
  * void inc(void* modVal, const void* baseVal){
@@ -48,7 +65,7 @@ int concEnum(int* dest, int len, int nWorkers);
  * 
  * @note Only the `dest` vector is modified by this function.
  * 
- * @warning If `nWorkers` is less than or equal to 0, its value is taken as 1. If it is greater than the number of elements in the vector, then it is capped by the provided length of the vector.
+ * @warning If `nWorkers` is equal to `CONC_AUTO_WORKERS` (0), the number of threads is chosen by the library. If it is less than 0, its value is taken as 1. If it is greater than the number of elements in the vector, then it is capped by the provided length of the vector.
  * @warning It is assumed that the length of both vectors — `org` and `dest` — is equal to `len`.
  * @warning If `len` is less than or equal to 0, the function returns `ERROR_LENGTH`.
  * @warning If `elemSize` is less than or equal to 0, the function returns `ERROR_SIZE`.
@@ -86,7 +103,7 @@ int concMap(void* dest,
  * ```
  * @note Only the value pointed by `dest` is modified by this function.
  * 
- * @warning If `nWorkers` is less than or equal to 0, its value is taken as 1. If it is greater than the number of elements in the vector, then it is capped by the provided length of the vector.
+ * @warning If `nWorkers` is equal to `CONC_AUTO_WORKERS` (0), the number of threads is chosen by the library. If it is less than 0, its value is taken as 1. If it is greater than the number of elements in the vector, then it is capped by the provided length of the vector.
  * @warning If `len` is less than or equal to 0, the function returns `ERROR_LENGTH`.
  * @warning If `elemSize` is equal to 0, the function returns `ERROR_SIZE`.
  */
@@ -95,4 +112,383 @@ int concReduce(void* dest,
                size_t elemSize,
                int len,
                void (*func)(void*, const void*),
-               int nWorkers);
\ No newline at end of file
+               int nWorkers);
+
+/**
+ * @brief Function that zeroes a vector, with the same partition among threads as the other functions of this library.
+ * 
+ * @param dest Base pointer of the vector.
+ * @param elemSize Size, in bytes, of each element in the vector.
+ * @param len Length of the vector.
+ * @param nWorkers Number of threads to be used.
+ * @return 0 in success, error code otherwise.
+ * 
+ * @note Besides zeroing, this is the first touch of a fresh vector (see vecAlloc.h): each page is placed on the NUMA node of the thread that will process it, provided the later calls use the same `len` and `nWorkers`.
+ * 
+ * @warning If `nWorkers` is equal to `CONC_AUTO_WORKERS` (0), the number of threads is chosen by the library (and may differ from the one chosen by later auto mode calls). If it is less than 0, its value is taken as 1. If it is greater than the number of elements in the vector, then it is capped by the provided length of the vector.
+ * @warning If `len` is less than or equal to 0, the function returns `ERROR_LENGTH`.
+ * @warning If `elemSize` is equal to 0, the function returns `ERROR_SIZE`.
+ */
+int concZero(void* dest, size_t elemSize, int len, int nWorkers);
+
+/**
+ * @brief Function that counts, for each key, the elements of a vector that have it (a histogram).
+ * 
+ * @param bins Base pointer of the vector of counts, of `nBins` values, onto which the counts are added.
+ * @param nBins Number of keys (the valid keys are `0` to `nBins - 1`).
+ * @param vec Base pointer of the vector.
+ * @param elemSize Size, in bytes, of each element in the vector.
+ * @param len Length of the vector.
+ * @param key Function that gives the key of an element.
+ * @param nWorkers Number of threads to be used.
+ * @return 0 in success, error code otherwise.
+ * 
+ * @note The key function, with signature `key(const void* elemVal)`, returns the bin of an element. Elements whose key is out of range are ignored. Here is an example that puts `int`s in [0, 100) into bins of width 10:
+ * ```c
+ * int decile(const void* elemVal){
+ *    return *(int*)elemVal / 10;
+ * }
+ * ```
+ * It could be passed to `concHistogram()` as (with `bins` being a zeroed vector of 10 `long long`s):
+ * ```c
+ * concHistogram(bins, 10, intVec, sizeof(int), len, decile, nWorkers);
+ * ```
+ * 
+ * @note Each thread counts its segment on private bins, with no atomic operations: a cache line aligned dense array when it is small, or, when the bins are many and the segment would leave most of them empty, a cache-sized hash table for the keys met first plus a list of single entries for the others. The private bins are then merged in parallel, each thread adding up every private copy of its own range of bins.
+ * 
+ * @note Only the vector pointed by `bins` is modified by this function.
+ * 
+ * @warning If `nWorkers` is equal to `CONC_AUTO_WORKERS` (0), the number of threads is chosen by the library. If it is less than 0, its value is taken as 1. If it is greater than the number of elements in the vector, then it is capped by the provided length of the vector.
+ * @warning If `len` or `nBins` are less than or equal to 0, the function returns `ERROR_LENGTH`.
+ * @warning If `elemSize` is equal to 0, the function returns `ERROR_SIZE`.
+ */
+int concHistogram(long long* bins,
+                  int nBins,
+                  void* vec,
+                  size_t elemSize,
+                  int len,
+                  int (*key)(const void*),
+                  int nWorkers);
+
+/**
+ * @brief Function that reduces, for each key, the elements of a vector that have it to a single value.
+ * 
+ * @param dest Base pointer of the vector of `nKeys` values (of `elemSize` bytes each) onto which the results are reduced.
+ * @param nKeys Number of keys (the valid keys are `0` to `nKeys - 1`).
+ * @param vec Base pointer of the vector.
+ * @param elemSize Size, in bytes, of each element in the vector.
+ * @param len Length of the vector.
+ * @param key Function that gives the key of an element (same convention as in concHistogram()).
+ * @param func Reducing function (same convention as in concReduce()).
+ * @param nWorkers Number of threads to be used.
+ * @return 0 in success, error code otherwise.
+ * 
+ * @note As in concReduce(), the result of each key is folded onto the value already in `dest`, which must therefore be initialized (e.g. with the neutral element of `func`). Keys with no element keep their value.
+ * 
+ * @note The private values of each thread and their parallel merge work as in concHistogram().
+ * 
+ * @warning If `nWorkers` is equal to `CONC_AUTO_WORKERS` (0), the number of threads is chosen by the library. If it is less than 0, its value is taken as 1. If it is greater than the number of elements in the vector, then it is capped by the provided length of the vector.
+ * @warning If `len` or `nKeys` are less than or equal to 0, the function returns `ERROR_LENGTH`.
+ * @warning If `elemSize` is equal to 0, the function returns `ERROR_SIZE`.
+ */
+int concReduceByKey(void* dest,
+                    int nKeys,
+                    void* vec,
+                    size_t elemSize,
+                    int len,
+                    int (*key)(const void*),
+                    void (*func)(void*, const void*),
+                    int nWorkers);
+
+/**
+ * @brief Function that finds the lowest index of a vector whose element satisfies a predicate.
+ * 
+ * @param dest Pointer to the variable in which the index is to be saved (-1 if no element satisfies `pred`).
+ * @param vec Base pointer of the vector.
+ * @param elemSize Size, in bytes, of each element in the vector.
+ * @param len Length of the vector.
+ * @param pred Predicate.
+ * @param nWorkers Number of threads to be used.
+ * @return 0 in success, error code otherwise.
+ * 
+ * @note The predicate `pred`, with signature `pred(const void* elemVal)`, returns nonzero for the elements searched for. Here is an example that looks for negative `int`s:
+ * ```c
+ * int isNegative(const void* elemVal){
+ *    return *(int*)elemVal < 0;
+ * }
+ * ```
+ * It could be passed to `concFind()` as (with `idx`, `intVec`, `len` and `nWorkers` being predefined variables):
+ * ```c
+ * concFind(&idx, intVec, sizeof(int), len, isNegative, nWorkers);
+ * ```
+ * 
+ * @note Threads claim chunks of the vector in increasing order and share a cancellation flag (the lowest match found so far): they stop testing as soon as every index below it is tested, so elements past the first match are mostly never read.
+ * 
+ * @warning If `nWorkers` is equal to `CONC_AUTO_WORKERS` (0), the number of threads is chosen by the library. If it is less than 0, its value is taken as 1. If it is greater than the number of elements in the vector, then it is capped by the provided length of the vector.
+ * @warning If `len` is less than or equal to 0, the function returns `ERROR_LENGTH`.
+ * @warning If `elemSize` is equal to 0, the function returns `ERROR_SIZE`.
+ */
+int concFind(int* dest, void* vec, size_t elemSize, int len, int (*pred)(const void*), int nWorkers);
+
+/**
+ * @brief Function that tells whether some element of a vector satisfies a predicate.
+ * 
+ * @param dest Pointer to the variable in which the answer (1 or 0) is to be saved.
+ * @param vec Base pointer of the vector.
+ * @param elemSize Size, in bytes, of each element in the vector.
+ * @param len Length of the vector.
+ * @param pred Predicate (same convention as in concFind()).
+ * @param nWorkers Number of threads to be used.
+ * @return 0 in success, error code otherwise.
+ * 
+ * @note Every thread stops as soon as any of them finds a match.
+ * 
+ * @warning Same restrictions on `nWorkers`, `len` and `elemSize` as in concFind().
+ */
+int concAny(int* dest, void* vec, size_t elemSize, int len, int (*pred)(const void*), int nWorkers);
+
+/**
+ * @brief Function that tells whether every element of a vector satisfies a predicate.
+ * 
+ * @param dest Pointer to the variable in which the answer (1 or 0) is to be saved.
+ * @param vec Base pointer of the vector.
+ * @param elemSize Size, in bytes, of each element in the vector.
+ * @param len Length of the vector.
+ * @param pred Predicate (same convention as in concFind()).
+ * @param nWorkers Number of threads to be used.
+ * @return 0 in success, error code otherwise.
+ * 
+ * @note Every thread stops as soon as any of them finds an element that does not satisfy `pred`.
+ * 
+ * @warning Same restrictions on `nWorkers`, `len` and `elemSize` as in concFind().
+ */
+int concAll(int* dest, void* vec, size_t elemSize, int len, int (*pred)(const void*), int nWorkers);
+
+/**
+ * @brief Function that finds the minimum element of a vector, along with its index.
+ * 
+ * @param destVal Pointer to the variable in which the minimum is to be copied (`NULL` if not needed).
+ * @param destIdx Pointer to the variable in which its index is to be saved (`NULL` if not needed).
+ * @param vec Base pointer of the vector.
+ * @param elemSize Size, in bytes, of each element in the vector.
+ * @param len Length of the vector.
+ * @param cmp Comparison function.
+ * @param nWorkers Number of threads to be used.
+ * @return 0 in success, error code otherwise.
+ * 
+ * @note The comparison function `cmp`, with signature `cmp(const void* a, const void* b)`, follows the convention of `qsort()`: it returns a negative value if `a` comes before `b`, 0 if they are equivalent and a positive value otherwise.
+ * 
+ * @note If the minimum appears more than once, the lowest index is given. Unlike the searches, the whole vector must be read, so there is no early exit.
+ * 
+ * @warning Same restrictions on `nWorkers`, `len` and `elemSize` as in concFind().
+ */
+int concArgMin(void* destVal, int* destIdx, void* vec, size_t elemSize, int len, int (*cmp)(const void*, const void*), int nWorkers);
+
+/**
+ * @brief Function that finds the maximum element of a vector, along with its index.
+ * 
+ * @note Same parameters and conventions as concArgMin() (on ties, the lowest index is given too).
+ */
+int concArgMax(void* destVal, int* destIdx, void* vec, size_t elemSize, int len, int (*cmp)(const void*, const void*), int nWorkers);
+
+/**
+ * @brief Function that sets how the workers of every following call are pinned to CPUs.
+ * 
+ * @param aff Pointer to the placement (see affinity.h), `NULL` to stop pinning. Worker `i` of each call runs on the `i`-th CPU of the placement.
+ * 
+ * @warning Only the pointer is kept: the placement must stay valid while it is in use.
+ */
+void concSetAffinity(const t_affinity* aff);
+
+/**
+ * @brief Function that returns the placement set by concSetAffinity().
+ * 
+ * @return Pointer to the placement, `NULL` if the workers are not pinned.
+ * 
+ * @note Meant for modules built on top of this library (e.g. concGemm.h), so that their workers follow the same placement.
+ */
+const t_affinity* concGetAffinity(void);
+
+/**
+ * @brief Function that discards every cached calibration used by the `CONC_AUTO_WORKERS` mode.
+ * 
+ * @note The next auto mode call of each callback is calibrated again. Useful when the cost of a callback depends on state that changed (e.g. the data it points to).
+ */
+void concResetCalibration(void);
+
+/**
+ * @brief Opaque context that holds reusable memory for the functions of this library.
+ * 
+ * A context owns, for each worker, a cache-line-aligned scratch slot (holding the arguments of the thread and its partial results) and a bump arena for temporaries of the caller. Calls made through the same context reuse this memory instead of allocating it every time.
+ * 
+ * @warning A context must not be used by two calls at the same time.
+ * 
+ * @sa See concCtxCreate() for the function that builds this.
+ */
+typedef struct t_conc_ctx t_conc_ctx;
+
+/**
+ * @brief Structure that reports the heap allocations made on behalf of a context.
+ * 
+ * @sa See concCtxStats() for the function that fills this.
+ */
+typedef struct {
+  long calls;      /**< Number of library calls made with the context. */
+  long allocs;     /**< Total number of heap allocations made on behalf of the context (after its creation). */
+  long lastAllocs; /**< Number of heap allocations made since the beginning of the last call. */
+} t_conc_stats;
+
+/**
+ * @brief Function that creates a context.
+ * 
+ * @param maxWorkers Number of workers that get a preallocated scratch slot.
+ * @param scratchSize Size, in bytes, of the scratch of each worker (the largest `elemSize` passed to concReduceCtx()).
+ * @param arenaSize Initial size, in bytes, of the arena used by concCtxAlloc().
+ * @return Pointer to the context, `NULL` if allocation failed.
+ * 
+ * @note Workers beyond `maxWorkers`, reductions of elements bigger than `scratchSize` and temporaries that do not fit in the arena still work, but fall back to the heap (and are counted by concCtxStats()).
+ */
+t_conc_ctx* concCtxCreate(int maxWorkers, size_t scratchSize, size_t arenaSize);
+
+/**
+ * @brief Function that frees a context and all the memory it owns.
+ * 
+ * @param ctx Pointer to the context (`NULL` is accepted).
+ */
+void concCtxDestroy(t_conc_ctx* ctx);
+
+/**
+ * @brief Function that allocates a temporary from the arena of a context.
+ * 
+ * @param ctx Pointer to the context.
+ * @param size Size, in bytes, of the temporary.
+ * @return Cache-line-aligned pointer to the temporary, `NULL` if allocation failed.
+ * 
+ * @note The memory is not initialized. It stays valid until the next call to concCtxReset().
+ */
+void* concCtxAlloc(t_conc_ctx* ctx, size_t size);
+
+/**
+ * @brief Function that releases, at once, every temporary taken from the arena of a context.
+ * 
+ * @param ctx Pointer to the context.
+ * 
+ * @note If the temporaries did not fit in the arena since the last reset, the arena is grown to their total size, so that the same sequence of requests is served without heap allocations afterwards.
+ */
+void concCtxReset(t_conc_ctx* ctx);
+
+/**
+ * @brief Function that reads the allocation counters of a context.
+ * 
+ * @param ctx Pointer to the context.
+ * @param stats Pointer to the structure to be filled.
+ */
+void concCtxStats(const t_conc_ctx* ctx, t_conc_stats* stats);
+
+/**
+ * @brief Same as concEnum(), but taking the memory it needs from the context `ctx` (`NULL` behaves exactly as concEnum()).
+ */
+int concEnumCtx(t_conc_ctx* ctx, int* dest, int len, int nWorkers);
+
+/**
+ * @brief Same as concMap(), but taking the memory it needs from the context `ctx` (`NULL` behaves exactly as concMap()).
+ */
+int concMapCtx(t_conc_ctx* ctx,
+               void* dest,
+               size_t destElemSize,
+               void* org,
+               size_t orgElemSize,
+               int len,
+               void (*func)(void*, const void*),
+               int nWorkers);
+
+/**
+ * @brief Same as concReduce(), but taking the memory it needs from the context `ctx` (`NULL` behaves exactly as concReduce()).
+ */
+int concReduceCtx(t_conc_ctx* ctx,
+                  void* dest,
+                  void* vec,
+                  size_t elemSize,
+                  int len,
+                  void (*func)(void*, const void*),
+                  int nWorkers);
+
+/**
+ * @brief Opaque handle (future) of an operation running in the background.
+ * 
+ * Its input is split in segments, one per thread, and the completion of each segment is tracked separately. That lets a dependent operation (see the `after` parameter of concMapAsync() and concReduceAsync()) start each of its segments as soon as the elements it reads are ready, instead of waiting for the whole previous operation.
+ * 
+ * @sa See concWait(), concTest() and concFutureDestroy() for the functions that operate on this.
+ */
+typedef struct t_conc_future t_conc_future;
+
+/**
+ * @brief Asynchronous version of concMap(): launches the mapping and returns immediately.
+ * 
+ * @param after Future of the operation whose output is read by this one (`NULL` if there is none). Element `i` of `org` is only read after the segment of `after` that contains element `i` is finished.
+ * @param dest Base pointer of the destination vector.
+ * @param destElemSize Size, in bytes, of each element in the destination vector.
+ * @param org Base pointer of the origin vector.
+ * @param orgElemSize Size, in bytes, of each element in the origin vector.
+ * @param len Length of the vectors.
+ * @param func Mapping function (same convention as in concMap()).
+ * @param nWorkers Number of threads to be used (`CONC_AUTO_WORKERS` uses the cached calibration of `func`, or every online CPU if there is none).
+ * @return Future of the operation, `NULL` in case of invalid arguments or failure.
+ * 
+ * @note Chaining is transitive: if `c` runs after `b`, which runs after `a`, a finished segment of `b` implies the matching elements of `a` are finished too.
+ * 
+ * @note The new operation keeps its own reference to `after`, so the caller may destroy `after` at any moment.
+ */
+t_conc_future* concMapAsync(t_conc_future* after,
+                            void* dest,
+                            size_t destElemSize,
+                            void* org,
+                            size_t orgElemSize,
+                            int len,
+                            void (*func)(void*, const void*),
+                            int nWorkers);
+
+/**
+ * @brief Asynchronous version of concReduce(): launches the reduction and returns immediately.
+ * 
+ * @param after Future of the operation whose output is read by this one (`NULL` if there is none). Element `i` of `vec` is only read after the segment of `after` that contains element `i` is finished.
+ * @param dest Pointer to the variable in which the result of reducing is to be saved (only written once every segment is finished).
+ * @param vec Base pointer of the vector.
+ * @param elemSize Size, in bytes, of each element in the vector.
+ * @param len Length of the vector.
+ * @param func Reducing function (same convention as in concReduce()).
+ * @param nWorkers Number of threads to be used (`CONC_AUTO_WORKERS` uses the cached calibration of `func`, or every online CPU if there is none).
+ * @return Future of the operation, `NULL` in case of invalid arguments or failure.
+ */
+t_conc_future* concReduceAsync(t_conc_future* after,
+                               void* dest,
+                               void* vec,
+                               size_t elemSize,
+                               int len,
+                               void (*func)(void*, const void*),
+                               int nWorkers);
+
+/**
+ * @brief Function that checks, without blocking, whether an asynchronous operation is finished.
+ * 
+ * @param f Pointer to the future.
+ * @return 1 if every segment is finished (and, for reductions, `dest` is written), 0 otherwise.
+ */
+int concTest(t_conc_future* f);
+
+/**
+ * @brief Function that blocks until an asynchronous operation is finished.
+ * 
+ * @param f Pointer to the future.
+ * @return 0 in success, error code otherwise.
+ * 
+ * @warning Only one thread may wait on a given future.
+ */
+int concWait(t_conc_future* f);
+
+/**
+ * @brief Function that waits for an asynchronous operation (if still running) and releases its future.
+ * 
+ * @param f Pointer to the future (`NULL` is accepted).
+ */
+void concFutureDestroy(t_conc_future* f);
\ No newline at end of file
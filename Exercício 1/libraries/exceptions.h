@@ -31,16 +31,26 @@ int _checkSize(size_t size);
  */
 #define makeError(checkFunc, errorID, errorMsg, ...) do {   \
   if (checkFunc(__VA_ARGS__)){                              \
-    fprintf(stderr,                                         \
-            "ERROR (file %s, function %s, line %d): %s\n",  \
-            __FILE__,                                       \
-            __func__,                                       \
-            __LINE__,                                       \
-            errorMsg);                                      \
+    printError(errorMsg);                                   \
     return errorID;                                         \
   }                                                         \
 } while (0)
 
+/**
+ * @brief Prints an error message, tagged with its location, without returning.
+ * 
+ * Used by `makeError` and by functions whose return type cannot carry an error code.
+ * 
+ * @param errorMsg String constant that details the error.
+ */
+#define printError(errorMsg)                                \
+  fprintf(stderr,                                           \
+          "ERROR (file %s, function %s, line %d): %s\n",    \
+          __FILE__,                                         \
+          __func__,                                         \
+          __LINE__,                                         \
+          errorMsg)
+
 /**
  * @brief Checks whether a pointer returned by malloc is NULL or not and raises `ERROR_MALLOC` if so.
  * @param ptr Pointer to memory address.
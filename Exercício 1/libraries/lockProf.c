@@ -0,0 +1,351 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lockProf.h"
+
+#ifdef LOCKPROF
+
+#define PROF_MAX_HELD 16 /**< Maximum number of objects held at once by a thread. */
+
+/**
+ * @brief Structure that holds the statistics of a call site, as seen by one thread.
+ */
+typedef struct {
+  long acqs;                  /**< Number of acquisitions. */
+  long contended;             /**< Number of acquisitions that had to wait. */
+  long long waitNs;           /**< Total time spent waiting (ns). */
+  long long maxWaitNs;        /**< Longest wait (ns). */
+  long holds;                 /**< Number of measured holds. */
+  long long holdNs;           /**< Total time holding (ns). */
+  long hist[PROF_NBUCKETS];   /**< Histogram of the waits (log2 of ns). */
+} t_prof_stats;
+
+/**
+ * @brief Structure that holds the statistics of a thread.
+ */
+typedef struct t_prof_thread {
+  int idx;                              /**< Index of the thread, in order of first profiled operation. */
+  long long first;                      /**< Instant of the first profiled operation (ns). */
+  long long last;                       /**< Instant of the last profiled operation (ns). */
+  t_prof_stats sites[PROF_MAX_SITES];   /**< Statistics of each call site. */
+  struct t_prof_thread* next;           /**< Next thread in the registry. */
+} t_prof_thread;
+
+/**
+ * @brief Structure that describes an object held by the calling thread.
+ */
+typedef struct {
+  const void* obj;  /**< Mutex or semaphore held. */
+  int site;         /**< Call site of the acquisition. */
+  long long since;  /**< Instant of the acquisition (ns). */
+} t_prof_held;
+
+static pthread_mutex_t registry = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t reportOnce = PTHREAD_ONCE_INIT;
+static t_prof_site* sites[PROF_MAX_SITES];
+static int nSites = 0;
+static t_prof_thread* threads = NULL;
+static int nThreads = 0;
+
+static __thread t_prof_thread* self = NULL;
+static __thread t_prof_held held[PROF_MAX_HELD];
+static __thread int nHeld = 0;
+
+/**
+ * @brief Auxiliar function that reads the monotonic clock.
+ * 
+ * @return Current instant (ns).
+ */
+static long long nowNs(){
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * @brief Auxiliar function that formats a duration with a suitable unit.
+ * 
+ * @param ns Duration (ns).
+ * @param buf Buffer in which the text is to be written (at least 16 bytes).
+ * @return `buf`.
+ */
+static char* fmtNs(double ns, char* buf){
+  if (ns < 1e3)
+    snprintf(buf, 16, "%.0fns", ns);
+  else if (ns < 1e6)
+    snprintf(buf, 16, "%.1fus", ns / 1e3);
+  else if (ns < 1e9)
+    snprintf(buf, 16, "%.1fms", ns / 1e6);
+  else
+    snprintf(buf, 16, "%.2fs", ns / 1e9);
+  return buf;
+}
+
+static void profReport();
+
+/**
+ * @brief Auxiliar function that registers the report at exit.
+ */
+static void registerReport(){
+  atexit(profReport);
+}
+
+/**
+ * @brief Auxiliar function that returns the statistics of the calling thread, registering it on its first call.
+ * 
+ * @return Statistics of the calling thread.
+ */
+static t_prof_thread* profSelf(){
+  if (self)
+    return self;
+
+  pthread_once(&reportOnce, registerReport);
+
+  if (!(self = (t_prof_thread*)calloc(1, sizeof(t_prof_thread)))){
+    fprintf(stderr, "lockProf: could not allocate thread statistics!\n");
+    exit(1);
+  }
+  self->first = nowNs();
+
+  pthread_mutex_lock(&registry);
+  self->idx = nThreads++;
+  self->next = threads;
+  threads = self;
+  pthread_mutex_unlock(&registry);
+
+  return self;
+}
+
+/**
+ * @brief Auxiliar function that returns the index of a call site, registering it on its first use.
+ * 
+ * @param site Call site.
+ * @return Index of the site.
+ */
+static int siteId(t_prof_site* site){
+  int id = __atomic_load_n(&site->id, __ATOMIC_ACQUIRE);
+
+  if (id)
+    return id - 1;
+
+  pthread_mutex_lock(&registry);
+  if (!(id = site->id)){
+    if (nSites == PROF_MAX_SITES){
+      fprintf(stderr, "lockProf: more than %d call sites!\n", PROF_MAX_SITES);
+      exit(1);
+    }
+    sites[nSites] = site;
+    id = ++nSites;
+    __atomic_store_n(&site->id, id, __ATOMIC_RELEASE);
+  }
+  pthread_mutex_unlock(&registry);
+
+  return id - 1;
+}
+
+/**
+ * @brief Auxiliar function that records an acquisition.
+ * 
+ * @param site Index of the call site.
+ * @param start Instant in which the acquisition started (ns).
+ * @param contended Whether the acquisition had to wait.
+ * @return Instant in which the acquisition ended (ns).
+ */
+static long long recordAcq(int site, long long start, int contended){
+  t_prof_thread* me = profSelf();
+  t_prof_stats* st = &me->sites[site];
+  long long now = nowNs();
+
+  st->acqs++;
+  if (contended){
+    long long wait = now - start;
+    int bucket = 0;
+
+    while (bucket < PROF_NBUCKETS - 1 && (wait >> (bucket + 1)))
+      bucket++;
+
+    st->contended++;
+    st->waitNs += wait;
+    if (wait > st->maxWaitNs)
+      st->maxWaitNs = wait;
+    st->hist[bucket]++;
+  }
+
+  me->last = now;
+  return now;
+}
+
+/**
+ * @brief Auxiliar function that marks an object as held by the calling thread.
+ */
+static void pushHeld(const void* obj, int site, long long since){
+  if (nHeld < PROF_MAX_HELD)
+    held[nHeld++] = (t_prof_held){obj, site, since};
+}
+
+/**
+ * @brief Auxiliar function that releases an object held by the calling thread, recording its hold time.
+ * 
+ * Objects not held by the calling thread (e.g. a semaphore posted by a producer) are ignored.
+ */
+static void popHeld(const void* obj){
+  for (int i = nHeld - 1; i >= 0; i--){
+    if (held[i].obj == obj){
+      t_prof_thread* me = profSelf();
+      t_prof_stats* st = &me->sites[held[i].site];
+      long long now = nowNs();
+
+      st->holds++;
+      st->holdNs += now - held[i].since;
+      me->last = now;
+
+      held[i] = held[--nHeld];
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Auxiliar function that restarts the hold time of an object held by the calling thread.
+ */
+static void restartHeld(const void* obj, long long since){
+  for (int i = nHeld - 1; i >= 0; i--)
+    if (held[i].obj == obj){
+      held[i].since = since;
+      return;
+    }
+}
+
+int _profMutexLock(pthread_mutex_t* mutex, t_prof_site* site){
+  int id = siteId(site);
+  long long start = nowNs();
+  int contended = 0;
+  int ret;
+
+  if ((ret = pthread_mutex_trylock(mutex))){
+    contended = 1;
+    if ((ret = pthread_mutex_lock(mutex)))
+      return ret;
+  }
+
+  pushHeld(mutex, id, recordAcq(id, start, contended));
+  return 0;
+}
+
+int _profMutexUnlock(pthread_mutex_t* mutex){
+  popHeld(mutex);
+  return pthread_mutex_unlock(mutex);
+}
+
+int _profCondWait(pthread_cond_t* cond, pthread_mutex_t* mutex, t_prof_site* site){
+  int id = siteId(site);
+  long long start = nowNs();
+  int ret = pthread_cond_wait(cond, mutex);
+
+  restartHeld(mutex, recordAcq(id, start, 1));
+  return ret;
+}
+
+int _profSemWait(sem_t* sem, t_prof_site* site, int hold){
+  int id = siteId(site);
+  long long start = nowNs();
+  int contended = 0;
+
+  if (sem_trywait(sem)){
+    contended = 1;
+    if (sem_wait(sem))
+      return -1;
+  }
+
+  long long now = recordAcq(id, start, contended);
+  if (hold)
+    pushHeld(sem, id, now);
+  return 0;
+}
+
+int _profSemPost(sem_t* sem){
+  popHeld(sem);
+  return sem_post(sem);
+}
+
+/**
+ * @brief Auxiliar function that writes the profile of every call site and thread to `stderr`.
+ */
+static void profReport(){
+  t_prof_stats total;
+  char b1[16], b2[16], b3[16], b4[16];
+
+  pthread_mutex_lock(&registry);
+
+  fprintf(stderr, "\n==== Lock profile ====\n");
+  fprintf(stderr, "%-40s %10s %10s %6s %10s %10s %10s %10s\n",
+          "Call site", "Acquired", "Contended", "%", "Wait", "Mean wait", "Max wait", "Mean hold");
+
+  for (int s = 0; s < nSites; s++){
+    char name[256];
+
+    memset(&total, 0, sizeof(total));
+    for (t_prof_thread* t = threads; t; t = t->next){
+      t_prof_stats* st = &t->sites[s];
+
+      total.acqs += st->acqs;
+      total.contended += st->contended;
+      total.waitNs += st->waitNs;
+      total.holds += st->holds;
+      total.holdNs += st->holdNs;
+      if (st->maxWaitNs > total.maxWaitNs)
+        total.maxWaitNs = st->maxWaitNs;
+      for (int b = 0; b < PROF_NBUCKETS; b++)
+        total.hist[b] += st->hist[b];
+    }
+
+    const char* file = strrchr(sites[s]->file, '/');
+    snprintf(name, sizeof(name), "%s (%s:%d)", sites[s]->what, file ? file + 1 : sites[s]->file, sites[s]->line);
+
+    fprintf(stderr, "%-40s %10ld %10ld %6.1f %10s %10s %10s %10s\n",
+            name, total.acqs, total.contended,
+            total.acqs ? 100.0 * total.contended / total.acqs : 0.0,
+            fmtNs(total.waitNs, b1),
+            fmtNs(total.contended ? (double)total.waitNs / total.contended : 0, b2),
+            fmtNs(total.maxWaitNs, b3),
+            total.holds ? fmtNs((double)total.holdNs / total.holds, b4) : "-");
+
+    if (total.contended){
+      fprintf(stderr, "    waits:");
+      for (int b = 0; b < PROF_NBUCKETS; b++)
+        if (total.hist[b])
+          fprintf(stderr, " >=%s:%ld", fmtNs((double)(1LL << b), b1), total.hist[b]);
+      fprintf(stderr, "\n");
+    }
+  }
+
+  fprintf(stderr, "\n%-10s %10s %10s %10s %10s %10s %6s\n",
+          "Thread", "Acquired", "Contended", "Wait", "Hold", "Active", "Wait%");
+
+  for (int i = 0; i < nThreads; i++){
+    t_prof_thread* t = threads;
+
+    while (t->idx != i)
+      t = t->next;
+
+    memset(&total, 0, sizeof(total));
+    for (int s = 0; s < nSites; s++){
+      total.acqs += t->sites[s].acqs;
+      total.contended += t->sites[s].contended;
+      total.waitNs += t->sites[s].waitNs;
+      total.holdNs += t->sites[s].holdNs;
+    }
+
+    long long active = t->last - t->first;
+    fprintf(stderr, "#%-9d %10ld %10ld %10s %10s %10s %6.1f\n",
+            i, total.acqs, total.contended,
+            fmtNs(total.waitNs, b1), fmtNs(total.holdNs, b2), fmtNs(active, b3),
+            active ? 100.0 * total.waitNs / active : 0.0);
+  }
+
+  pthread_mutex_unlock(&registry);
+}
+
+#endif
\ No newline at end of file
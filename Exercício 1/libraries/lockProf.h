@@ -0,0 +1,80 @@
+/**
+ * @file lockProf.h
+ * @brief Library of instrumented synchronization wrappers.
+ * 
+ * Library containing drop-in wrappers for `pthread_mutex_t`, `pthread_cond_t` and `sem_t` operations that profile contention. For each call site and each thread, they record the number of acquisitions, how many of them were contended, a histogram of the time spent waiting and the time each lock was held. A report is written to `stderr` when the program exits.
+ * 
+ * The profiling is only compiled in when `LOCKPROF` is defined (e.g. `-DLOCKPROF`); otherwise every wrapper expands to the plain call, with no overhead.
+ * 
+ * @note Hold times are measured from the acquisition to the release made by the same thread, so they are only kept for mutexes and for semaphores used as mutexes (`profSemLock()`/`profSemUnlock()`). Counting semaphores (`profSemWait()`/`profSemPost()`) have only their waits profiled.
+ */
+
+#pragma once
+
+#include <pthread.h>
+#include <semaphore.h>
+
+#ifdef LOCKPROF
+
+#define PROF_MAX_SITES 128 /**< Maximum number of profiled call sites. */
+#define PROF_NBUCKETS 40   /**< Number of buckets of the wait histograms (bucket `i` holds waits of [2^i, 2^(i+1)) ns). */
+
+/**
+ * @brief Structure that identifies a profiled call site (one static instance per use of a wrapper).
+ */
+typedef struct {
+  const char* file; /**< File of the call site. */
+  int line;         /**< Line of the call site. */
+  const char* what; /**< Operation and object, as written in the source. */
+  int id;           /**< Index of the site in the statistics (0 while not yet registered). */
+} t_prof_site;
+
+int _profMutexLock(pthread_mutex_t* mutex, t_prof_site* site);
+int _profMutexUnlock(pthread_mutex_t* mutex);
+int _profCondWait(pthread_cond_t* cond, pthread_mutex_t* mutex, t_prof_site* site);
+int _profSemWait(sem_t* sem, t_prof_site* site, int hold);
+int _profSemPost(sem_t* sem);
+
+/**
+ * @brief Auxiliar macro that declares the static call site of a wrapper and calls its profiled implementation.
+ * 
+ * @param what String describing the operation.
+ * @param call Call to the profiled implementation (using `_site`).
+ */
+#define _profAt(what, call) ({                                    \
+  static t_prof_site _site = {__FILE__, __LINE__, what, 0};       \
+  call;                                                           \
+})
+
+/** @brief Profiled `pthread_mutex_lock()`. */
+#define profMutexLock(mutex) _profAt("lock " #mutex, _profMutexLock(mutex, &_site))
+
+/** @brief Profiled `pthread_mutex_unlock()`. */
+#define profMutexUnlock(mutex) _profMutexUnlock(mutex)
+
+/** @brief Profiled `pthread_cond_wait()` (the wait counts as contended; the mutex hold restarts when it returns). */
+#define profCondWait(cond, mutex) _profAt("wait " #cond, _profCondWait(cond, mutex, &_site))
+
+/** @brief Profiled `sem_wait()` on a counting semaphore. */
+#define profSemWait(sem) _profAt("sem_wait " #sem, _profSemWait(sem, &_site, 0))
+
+/** @brief Profiled `sem_post()` on a counting semaphore. */
+#define profSemPost(sem) sem_post(sem)
+
+/** @brief Profiled `sem_wait()` on a semaphore used as a mutex (its hold time is measured). */
+#define profSemLock(sem) _profAt("sem_lock " #sem, _profSemWait(sem, &_site, 1))
+
+/** @brief Profiled `sem_post()` on a semaphore used as a mutex. */
+#define profSemUnlock(sem) _profSemPost(sem)
+
+#else
+
+#define profMutexLock(mutex) pthread_mutex_lock(mutex)
+#define profMutexUnlock(mutex) pthread_mutex_unlock(mutex)
+#define profCondWait(cond, mutex) pthread_cond_wait(cond, mutex)
+#define profSemWait(sem) sem_wait(sem)
+#define profSemPost(sem) sem_post(sem)
+#define profSemLock(sem) sem_wait(sem)
+#define profSemUnlock(sem) sem_post(sem)
+
+#endif
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <sched.h>
+#include "mpmcQueue.h"
+#include "spinLock.h"
+
+#define CELL_HEADER 16 /**< Offset, in bytes, of the element inside a slot (keeps it aligned). */
+#define QUEUE_SPINS 64 /**< Number of spins before a blocked push/pop starts yielding the CPU. */
+
+struct t_mpmc_queue {
+  _Alignas(64) atomic_size_t head; /**< Position of the next insertion (only touched by producers). */
+  _Alignas(64) atomic_size_t tail; /**< Position of the next removal (only touched by consumers). */
+  _Alignas(64) atomic_int closed;  /**< Whether the end of the stream was signaled. */
+  size_t mask;                     /**< Number of slots minus 1. */
+  size_t elemSize;                 /**< Size, in bytes, of each element. */
+  size_t stride;                   /**< Size, in bytes, of each slot. */
+  unsigned char* cells;            /**< Slots: a sequence number followed by the element. */
+};
+
+/**
+ * @brief Auxiliar function that returns the sequence number of the slot of a position.
+ * 
+ * The slot of position `pos` holds `pos` when it is free for that position, `pos + 1` when the element of that position is ready and `pos + capacity` once it has been consumed (i.e. free for the next lap).
+ */
+static atomic_size_t* seqOf(t_mpmc_queue* queue, size_t pos){
+  return (atomic_size_t*)(queue->cells + (pos & queue->mask) * queue->stride);
+}
+
+/**
+ * @brief Auxiliar function that waits a bit before retrying a blocked operation.
+ * 
+ * @param tries Number of tries made so far.
+ */
+static void backoff(int tries){
+  if (tries < QUEUE_SPINS)
+    cpuRelax();
+  else
+    sched_yield();
+}
+
+t_mpmc_queue* mpmcCreate(size_t capacity, size_t elemSize){
+  t_mpmc_queue* queue;
+  size_t nCells = 2;
+
+  while (nCells < capacity)
+    nCells <<= 1;
+
+  if (!(queue = (t_mpmc_queue*)aligned_alloc(64, sizeof(t_mpmc_queue))))
+    return NULL;
+
+  queue->mask = nCells - 1;
+  queue->elemSize = elemSize;
+  queue->stride = (CELL_HEADER + elemSize + CELL_HEADER - 1) / CELL_HEADER * CELL_HEADER;
+  if (!(queue->cells = (unsigned char*)aligned_alloc(64, (nCells * queue->stride + 63) / 64 * 64))){
+    free(queue);
+    return NULL;
+  }
+
+  for (size_t i = 0; i < nCells; i++)
+    atomic_init(seqOf(queue, i), i);
+  atomic_init(&queue->head, 0);
+  atomic_init(&queue->tail, 0);
+  atomic_init(&queue->closed, 0);
+
+  return queue;
+}
+
+void mpmcDestroy(t_mpmc_queue* queue){
+  if (!queue)
+    return;
+  free(queue->cells);
+  free(queue);
+}
+
+int mpmcTryPush(t_mpmc_queue* queue, const void* elem){
+  size_t pos = atomic_load_explicit(&queue->head, memory_order_relaxed);
+  atomic_size_t* seq;
+
+  while (1){
+    seq = seqOf(queue, pos);
+    intptr_t dif = (intptr_t)atomic_load_explicit(seq, memory_order_acquire) - (intptr_t)pos;
+
+    if (dif == 0){
+      // Slot free for this position: claim it (on failure, `pos` gets the current head)
+      if (atomic_compare_exchange_weak_explicit(&queue->head, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed))
+        break;
+    }
+    else if (dif < 0)
+      return 0; // Slot still holds the element of the previous lap: queue full
+    else
+      pos = atomic_load_explicit(&queue->head, memory_order_relaxed);
+  }
+
+  memcpy((unsigned char*)seq + CELL_HEADER, elem, queue->elemSize);
+  atomic_store_explicit(seq, pos + 1, memory_order_release);
+
+  return 1;
+}
+
+int mpmcTryPop(t_mpmc_queue* queue, void* elem){
+  size_t pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+  atomic_size_t* seq;
+
+  while (1){
+    seq = seqOf(queue, pos);
+    intptr_t dif = (intptr_t)atomic_load_explicit(seq, memory_order_acquire) - (intptr_t)(pos + 1);
+
+    if (dif == 0){
+      // Element of this position ready: claim it (on failure, `pos` gets the current tail)
+      if (atomic_compare_exchange_weak_explicit(&queue->tail, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed))
+        break;
+    }
+    else if (dif < 0)
+      return 0; // Element not written yet: queue empty
+    else
+      pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+  }
+
+  memcpy(elem, (unsigned char*)seq + CELL_HEADER, queue->elemSize);
+  atomic_store_explicit(seq, pos + queue->mask + 1, memory_order_release);
+
+  return 1;
+}
+
+void mpmcPush(t_mpmc_queue* queue, const void* elem){
+  for (int tries = 0; !mpmcTryPush(queue, elem); tries++)
+    backoff(tries);
+}
+
+int mpmcPop(t_mpmc_queue* queue, void* elem){
+  for (int tries = 0; !mpmcTryPop(queue, elem); tries++){
+    // Every insertion happened before the close: one last try tells whether anything is left
+    if (atomic_load_explicit(&queue->closed, memory_order_acquire))
+      return mpmcTryPop(queue, elem);
+    backoff(tries);
+  }
+
+  return 1;
+}
+
+void mpmcClose(t_mpmc_queue* queue){
+  atomic_store_explicit(&queue->closed, 1, memory_order_release);
+}
\ No newline at end of file
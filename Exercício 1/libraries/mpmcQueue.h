@@ -0,0 +1,79 @@
+/**
+ * @file mpmcQueue.h
+ * @brief Library of bounded lock-free multi-producer multi-consumer queues.
+ * 
+ * Library containing a bounded FIFO queue of generic elements (of a fixed size) based on Dmitry Vyukov's algorithm: every slot carries a sequence number telling whether it is ready to be written or read, so producers only contend among themselves (and consumers among themselves) on a compare-and-swap of their own index, and a producer can refill a slot as soon as it has been consumed.
+ * 
+ * The end of the stream is signaled with mpmcClose(): consumers blocked on mpmcPop() drain whatever is left and then return 0.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+/**
+ * @brief Opaque structure of a queue.
+ * 
+ * @sa See mpmcCreate() for the function that builds this.
+ */
+typedef struct t_mpmc_queue t_mpmc_queue;
+
+/**
+ * @brief Function that creates an empty queue.
+ * 
+ * @param capacity Minimum number of elements the queue holds (rounded up to a power of 2).
+ * @param elemSize Size, in bytes, of each element.
+ * @return Pointer to the queue, `NULL` if allocation failed.
+ */
+t_mpmc_queue* mpmcCreate(size_t capacity, size_t elemSize);
+
+/**
+ * @brief Function that frees a queue.
+ * 
+ * @param queue Pointer to the queue (`NULL` is accepted).
+ */
+void mpmcDestroy(t_mpmc_queue* queue);
+
+/**
+ * @brief Function that tries to insert an element without waiting.
+ * 
+ * @param queue Pointer to the queue.
+ * @param elem Pointer to the element to be copied into the queue.
+ * @return 1 if the element was inserted, 0 if the queue is full.
+ */
+int mpmcTryPush(t_mpmc_queue* queue, const void* elem);
+
+/**
+ * @brief Function that tries to remove the oldest element without waiting.
+ * 
+ * @param queue Pointer to the queue.
+ * @param elem Pointer to where the element is to be copied.
+ * @return 1 if an element was removed, 0 if the queue is empty.
+ */
+int mpmcTryPop(t_mpmc_queue* queue, void* elem);
+
+/**
+ * @brief Function that inserts an element, waiting (spinning, then yielding the CPU) while the queue is full.
+ * 
+ * @param queue Pointer to the queue.
+ * @param elem Pointer to the element to be copied into the queue.
+ */
+void mpmcPush(t_mpmc_queue* queue, const void* elem);
+
+/**
+ * @brief Function that removes the oldest element, waiting (spinning, then yielding the CPU) while the queue is empty.
+ * 
+ * @param queue Pointer to the queue.
+ * @param elem Pointer to where the element is to be copied.
+ * @return 1 if an element was removed, 0 if the queue was closed and is empty (end of the stream).
+ */
+int mpmcPop(t_mpmc_queue* queue, void* elem);
+
+/**
+ * @brief Function that signals the end of the stream.
+ * 
+ * @param queue Pointer to the queue.
+ * 
+ * @warning It must only be called after every producer has finished inserting.
+ */
+void mpmcClose(t_mpmc_queue* queue);
\ No newline at end of file
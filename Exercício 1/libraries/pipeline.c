@@ -0,0 +1,343 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "exceptions.h"
+#include "spinLock.h"
+#include "mpmcQueue.h"
+#include "pipeline.h"
+
+#define BATCH_HEADER 16 /**< Offset, in bytes, of the elements inside a batch (after its element count). */
+#define PIPE_SPINS 64   /**< Number of spins before a push to a full queue starts yielding the CPU. */
+
+/**
+ * @brief Structure that describes a stage.
+ */
+typedef struct {
+  const char* name;     /**< Name of the stage. */
+  t_pipe_func func;     /**< Callback. */
+  void* arg;            /**< Argument of the callback. */
+  size_t inSize;        /**< Size, in bytes, of the elements received (0 for the source). */
+  size_t outSize;       /**< Size, in bytes, of the elements emitted. */
+  int nThreads;         /**< Number of threads requested (after pipeRun(), the number actually created). */
+  int batch;            /**< Maximum number of elements in each batch emitted. */
+  size_t capacity;      /**< Capacity, in batches, of the next queue. */
+  size_t inBatchBytes;  /**< Size, in bytes, of a batch received. */
+  size_t outBatchBytes; /**< Size, in bytes, of a batch emitted. */
+  t_mpmc_queue* in;     /**< Queue from the previous stage (`NULL` for the source). */
+  t_mpmc_queue* out;    /**< Queue to the next stage (`NULL` for the last one). */
+  atomic_int live;      /**< Number of threads of the stage that have not finished yet. */
+  t_pipe_stats stats;   /**< Counters, gathered from the threads at the end of pipeRun(). */
+} t_pipe_stage;
+
+struct t_pipe_ctx {
+  t_pipeline* pl;          /**< Pipeline of the thread. */
+  t_pipe_stage* stage;     /**< Stage of the thread. */
+  int worker;              /**< Index of the thread inside its stage. */
+  int created;             /**< Whether the thread was created. */
+  pthread_t tid;           /**< Identifier of the thread. */
+  unsigned char* inBatch;  /**< Batch being consumed. */
+  unsigned char* outBatch; /**< Batch being filled. */
+  int outCount;            /**< Number of elements in `outBatch`. */
+  long long itemsIn;       /**< Elements received by the thread. */
+  long long itemsOut;      /**< Elements emitted by the thread. */
+  long long batchesOut;    /**< Batches pushed by the thread. */
+  double busyNs;           /**< Time spent inside the callback (including blocked time). */
+  double blockedNs;        /**< Time spent waiting for room in the next queue. */
+  double startNs;          /**< Instant the thread started. */
+  double endNs;            /**< Instant the thread finished. */
+};
+
+struct t_pipeline {
+  const t_affinity* aff; /**< Placement of the threads (`NULL` means no pinning). */
+  t_pipe_stage* stages;  /**< Stages, in order. */
+  int nStages;           /**< Number of stages. */
+  t_pipe_ctx* ctxs;      /**< Contexts of every thread, stage after stage (allocated by pipeRun()). */
+  int nCtxs;             /**< Number of contexts. */
+  atomic_int aborted;    /**< Whether the stream was abandoned (some stage got no thread). */
+};
+
+/**
+ * @brief Auxiliar function that reads a monotonic clock.
+ * 
+ * @return Current time, in nanoseconds.
+ */
+static double nowNs(void){
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/**
+ * @brief Auxiliar function that pushes the batch of a thread to the next queue, waiting while it is full.
+ * 
+ * @param ctx Context of the thread.
+ */
+static void flushBatch(t_pipe_ctx* ctx){
+  double t0;
+
+  if (ctx->outCount == 0)
+    return;
+
+  *(int*)ctx->outBatch = ctx->outCount;
+  ctx->outCount = 0;
+
+  // Backpressure: only a push that finds the queue full reads the clock
+  if (!mpmcTryPush(ctx->stage->out, ctx->outBatch)){
+    t0 = nowNs();
+    for (int tries = 0; !mpmcTryPush(ctx->stage->out, ctx->outBatch); tries++){
+      if (atomic_load_explicit(&ctx->pl->aborted, memory_order_relaxed))
+        break;
+      if (tries < PIPE_SPINS)
+        cpuRelax();
+      else
+        sched_yield();
+    }
+    ctx->blockedNs += nowNs() - t0;
+  }
+
+  ctx->batchesOut++;
+}
+
+/**
+ * @brief Auxiliar function that marks the end of `n` threads of a stage, closing the next queue when the last one ends.
+ * 
+ * @param stage Pointer to the stage.
+ * @param n Number of threads that ended (or that could not even be created).
+ */
+static void leaveStage(t_pipe_stage* stage, int n){
+  if (atomic_fetch_sub_explicit(&stage->live, n, memory_order_acq_rel) == n && stage->out)
+    mpmcClose(stage->out);
+}
+
+/**
+ * @brief Auxiliar function that runs a thread of a stage.
+ * 
+ * @param args Context of the thread (`t_pipe_ctx*`).
+ */
+static void* threadStage(void* args){
+  t_pipe_ctx* ctx = (t_pipe_ctx*)args;
+  t_pipe_stage* stage = ctx->stage;
+  double t0;
+
+  ctx->startNs = nowNs();
+
+  if (!stage->in){
+    // Source: a single call emits the whole stream of the thread
+    stage->func(ctx, NULL, stage->arg);
+    ctx->busyNs = nowNs() - ctx->startNs;
+  }
+  else
+    while (mpmcPop(stage->in, ctx->inBatch)){
+      int n = *(int*)ctx->inBatch;
+      const unsigned char* elems = ctx->inBatch + BATCH_HEADER;
+
+      t0 = nowNs();
+      for (int i = 0; i < n; i++)
+        stage->func(ctx, elems + i * stage->inSize, stage->arg);
+      ctx->busyNs += nowNs() - t0;
+      ctx->itemsIn += n;
+    }
+
+  if (stage->out){
+    t0 = nowNs();
+    flushBatch(ctx);
+    ctx->busyNs += nowNs() - t0;
+  }
+  ctx->endNs = nowNs();
+
+  leaveStage(stage, 1);
+  return NULL;
+}
+
+t_pipeline* pipeCreate(const t_affinity* aff){
+  t_pipeline* pl = (t_pipeline*)calloc(1, sizeof(t_pipeline));
+
+  if (!pl)
+    return NULL;
+
+  pl->aff = aff;
+  atomic_init(&pl->aborted, 0);
+  return pl;
+}
+
+int pipeAddStage(t_pipeline* pl, const char* name, t_pipe_func func, void* arg, size_t outElemSize, int nThreads, int batch, size_t capacity){
+  t_pipe_stage* stages = (t_pipe_stage*)realloc(pl->stages, (pl->nStages + 1) * sizeof(t_pipe_stage));
+  t_pipe_stage* stage;
+
+  checkMalloc(stages);
+  pl->stages = stages;
+  stage = &stages[pl->nStages++];
+
+  memset(stage, 0, sizeof(t_pipe_stage));
+  stage->name = name;
+  stage->func = func;
+  stage->arg = arg;
+  stage->outSize = outElemSize;
+  stage->nThreads = nThreads < 1 ? 1 : nThreads;
+  stage->batch = batch < 1 ? 1 : batch;
+  stage->capacity = capacity;
+  stage->outBatchBytes = (BATCH_HEADER + stage->batch * outElemSize + BATCH_HEADER - 1) / BATCH_HEADER * BATCH_HEADER;
+
+  return 0;
+}
+
+int pipeRun(t_pipeline* pl){
+  int nCtxs = 0, next = 0, starved = 0;
+
+  // Queues between consecutive stages (every stage but the last must emit something)
+  for (int s = 0; s < pl->nStages; s++){
+    t_pipe_stage* stage = &pl->stages[s];
+
+    if (s > 0){
+      stage->in = pl->stages[s - 1].out;
+      stage->inSize = pl->stages[s - 1].outSize;
+      stage->inBatchBytes = pl->stages[s - 1].outBatchBytes;
+    }
+    if (s < pl->nStages - 1){
+      checkSize(stage->outSize);
+      stage->out = mpmcCreate(stage->capacity, stage->outBatchBytes);
+      checkMalloc(stage->out);
+    }
+    atomic_init(&stage->live, stage->nThreads);
+    nCtxs += stage->nThreads;
+  }
+
+  pl->ctxs = (t_pipe_ctx*)calloc(nCtxs, sizeof(t_pipe_ctx));
+  checkMalloc(pl->ctxs);
+  pl->nCtxs = nCtxs;
+
+  for (int s = 0; s < pl->nStages; s++)
+    for (int w = 0; w < pl->stages[s].nThreads; w++, next++){
+      t_pipe_ctx* ctx = &pl->ctxs[next];
+
+      ctx->pl = pl;
+      ctx->stage = &pl->stages[s];
+      ctx->worker = w;
+      if (ctx->stage->in){
+        ctx->inBatch = (unsigned char*)aligned_alloc(16, ctx->stage->inBatchBytes);
+        checkMalloc(ctx->inBatch);
+      }
+      if (ctx->stage->out){
+        ctx->outBatch = (unsigned char*)aligned_alloc(16, ctx->stage->outBatchBytes);
+        checkMalloc(ctx->outBatch);
+      }
+    }
+
+  // Threads of a stage that could not be created just leave it; a stage with none abandons the stream
+  next = 0;
+  for (int s = 0; s < pl->nStages; s++){
+    t_pipe_stage* stage = &pl->stages[s];
+    int created = 0;
+
+    for (int w = 0; w < stage->nThreads; w++, next++){
+      pthread_attr_t attr;
+      pthread_attr_t* attrPtr = affinityAttr(pl->aff, next, &attr);
+
+      pl->ctxs[next].created = !pthread_create(&pl->ctxs[next].tid, attrPtr, threadStage, &pl->ctxs[next]);
+      created += pl->ctxs[next].created;
+      if (attrPtr)
+        pthread_attr_destroy(attrPtr);
+    }
+
+    if (created == 0){
+      starved = 1;
+      atomic_store(&pl->aborted, 1);
+      for (int q = 0; q < pl->nStages; q++)
+        if (pl->stages[q].out)
+          mpmcClose(pl->stages[q].out);
+    }
+    if (created < stage->nThreads)
+      leaveStage(stage, stage->nThreads - created);
+  }
+
+  for (int i = 0; i < nCtxs; i++)
+    if (pl->ctxs[i].created)
+      checkThreadJoin(pthread_join(pl->ctxs[i].tid, NULL));
+
+  // Gathering the counters of each stage
+  for (int s = 0, i = 0; s < pl->nStages; s++){
+    t_pipe_stage* stage = &pl->stages[s];
+    double first = 0, last = 0;
+    int created = 0;
+
+    memset(&stage->stats, 0, sizeof(t_pipe_stats));
+    stage->stats.name = stage->name;
+    for (int w = 0; w < stage->nThreads; w++, i++){
+      const t_pipe_ctx* ctx = &pl->ctxs[i];
+
+      if (!ctx->created)
+        continue;
+      if (!created++ || ctx->startNs < first)
+        first = ctx->startNs;
+      if (ctx->endNs > last)
+        last = ctx->endNs;
+      stage->stats.itemsIn += ctx->itemsIn;
+      stage->stats.itemsOut += ctx->itemsOut;
+      stage->stats.batchesOut += ctx->batchesOut;
+      stage->stats.busyTime += (ctx->busyNs - ctx->blockedNs) / 1e9;
+      stage->stats.blockedTime += ctx->blockedNs / 1e9;
+    }
+    stage->stats.nThreads = created;
+    stage->stats.wallTime = created ? (last - first) / 1e9 : 0;
+  }
+
+  return starved ? ERROR_THREAD_CREATE : 0;
+}
+
+void pipeEmit(t_pipe_ctx* ctx, const void* elem){
+  t_pipe_stage* stage = ctx->stage;
+
+  if (!stage->out || atomic_load_explicit(&ctx->pl->aborted, memory_order_relaxed))
+    return;
+
+  memcpy(ctx->outBatch + BATCH_HEADER + ctx->outCount * stage->outSize, elem, stage->outSize);
+  ctx->itemsOut++;
+  if (++ctx->outCount == stage->batch)
+    flushBatch(ctx);
+}
+
+int pipeWorker(const t_pipe_ctx* ctx){
+  return ctx->worker;
+}
+
+int pipeStats(const t_pipeline* pl, int stage, t_pipe_stats* stats){
+  if (stage < 0 || stage >= pl->nStages)
+    return -1;
+  *stats = pl->stages[stage].stats;
+  return 0;
+}
+
+void pipeReport(const t_pipeline* pl, FILE* out){
+  fprintf(out, "%-12s %7s %12s %12s %10s %9s %9s %9s %14s\n",
+          "Stage", "Threads", "In", "Out", "Batches", "Wall (s)", "Busy (s)", "Blkd (s)", "Rate (elem/s)");
+
+  for (int s = 0; s < pl->nStages; s++){
+    const t_pipe_stats* st = &pl->stages[s].stats;
+    // The source has no input: its rate is that of what it emits
+    long long items = s == 0 ? st->itemsOut : st->itemsIn;
+
+    fprintf(out, "%-12s %7d %12lld %12lld %10lld %9.3f %9.3f %9.3f %14.0f\n",
+            st->name, st->nThreads, st->itemsIn, st->itemsOut, st->batchesOut,
+            st->wallTime, st->busyTime, st->blockedTime, st->wallTime > 0 ? items / st->wallTime : 0);
+  }
+}
+
+void pipeDestroy(t_pipeline* pl){
+  if (!pl)
+    return;
+
+  for (int i = 0; i < pl->nCtxs; i++){
+    free(pl->ctxs[i].inBatch);
+    free(pl->ctxs[i].outBatch);
+  }
+  for (int s = 0; s < pl->nStages; s++)
+    mpmcDestroy(pl->stages[s].out);
+
+  free(pl->ctxs);
+  free(pl->stages);
+  free(pl);
+}
\ No newline at end of file
@@ -0,0 +1,147 @@
+/**
+ * @file pipeline.h
+ * @brief Library of multi-stage producer/consumer pipelines.
+ * 
+ * Library containing a pipeline of stages linked by bounded queues (see mpmcQueue.h). Each stage runs its callback on any number of threads, reads the elements emitted by the previous stage and emits elements of its own type to the next one. Elements travel in batches (one queue operation per batch instead of per element), producers block while the next queue is full (backpressure), and when the last thread of a stage finishes, the queue after it is closed, so the following stage drains whatever is left and finishes too.
+ * 
+ * A typical use, with a source stage followed by two others, would be:
+ * ```c
+ * t_pipeline* pl = pipeCreate(NULL);
+ * pipeAddStage(pl, "gen", generate, &genArgs, sizeof(long long), 1, 64, 1024);
+ * pipeAddStage(pl, "test", test, NULL, sizeof(long long), 4, 64, 1024);
+ * pipeAddStage(pl, "sum", sum, sums, 0, 1, 0, 0);
+ * pipeRun(pl);
+ * pipeReport(pl, stderr);
+ * pipeDestroy(pl);
+ * ```
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stddef.h>
+#include "affinity.h"
+
+/**
+ * @brief Opaque structure of a pipeline.
+ * 
+ * @sa See pipeCreate() for the function that builds this.
+ */
+typedef struct t_pipeline t_pipeline;
+
+/**
+ * @brief Opaque structure that identifies a thread of a stage inside its callback.
+ */
+typedef struct t_pipe_ctx t_pipe_ctx;
+
+/**
+ * @brief Callback of a stage.
+ * 
+ * The callback, with signature `func(t_pipe_ctx* ctx, const void* elem, void* arg)`, is called once for each element received from the previous stage (`elem`), and may emit any number of elements to the next stage with pipeEmit(). The first stage (the source) has no input: its callback is called once per thread, with `elem` equal to `NULL`, and emits the whole stream by itself (threads of the source must split the work among themselves, e.g. through an atomic counter in `arg`).
+ */
+typedef void (*t_pipe_func)(t_pipe_ctx* ctx, const void* elem, void* arg);
+
+/**
+ * @brief Structure that holds the counters of a stage.
+ * 
+ * @sa See pipeStats() for the function that fills this.
+ */
+typedef struct {
+  const char* name;     /**< Name of the stage. */
+  int nThreads;         /**< Number of threads that ran the stage. */
+  long long itemsIn;    /**< Elements received from the previous stage. */
+  long long itemsOut;   /**< Elements emitted to the next stage. */
+  long long batchesOut; /**< Batches pushed to the next queue. */
+  double wallTime;      /**< Time, in seconds, from the start of the first thread of the stage to the end of the last one. */
+  double busyTime;      /**< Time, in seconds, spent inside the callback (minus `blockedTime`), summed over the threads of the stage. */
+  double blockedTime;   /**< Time, in seconds, spent waiting for room in a full next queue (backpressure), summed over the threads. */
+} t_pipe_stats;
+
+/**
+ * @brief Function that creates an empty pipeline.
+ * 
+ * @param aff Placement of the threads (the i-th thread created, counting every stage in order, goes to the i-th CPU of the policy), `NULL` for no pinning.
+ * @return Pointer to the pipeline, `NULL` if allocation failed.
+ */
+t_pipeline* pipeCreate(const t_affinity* aff);
+
+/**
+ * @brief Function that appends a stage to a pipeline.
+ * 
+ * @param pl Pointer to the pipeline.
+ * @param name Name of the stage (kept by reference, used in reports).
+ * @param func Callback of the stage.
+ * @param arg Argument passed, untouched, to every call of `func`.
+ * @param outElemSize Size, in bytes, of the elements emitted by the stage (0 for the last stage, that emits nothing).
+ * @param nThreads Number of threads of the stage (values less than 1 are taken as 1).
+ * @param batch Maximum number of elements in each batch pushed to the next queue (values less than 1 are taken as 1).
+ * @param capacity Capacity, in batches, of the queue to the next stage.
+ * @return 0 in success, error code otherwise.
+ * 
+ * @warning Stages can only be added before pipeRun().
+ * @warning If `outElemSize` is 0, the stage must be the last one, and calling pipeEmit() from it does nothing.
+ */
+int pipeAddStage(t_pipeline* pl, const char* name, t_pipe_func func, void* arg, size_t outElemSize, int nThreads, int batch, size_t capacity);
+
+/**
+ * @brief Function that runs a pipeline until every stage has finished.
+ * 
+ * @param pl Pointer to the pipeline.
+ * @return 0 in success, error code otherwise (e.g. `ERROR_THREAD_CREATE` if some stage got no thread at all, in which case the stream is abandoned and the threads already created are joined).
+ * 
+ * @note If only some of the threads of a stage could be created, the stage runs with the ones that were.
+ */
+int pipeRun(t_pipeline* pl);
+
+/**
+ * @brief Function that emits an element to the next stage, from inside a callback.
+ * 
+ * @param ctx Context received by the callback.
+ * @param elem Pointer to the element (of the `outElemSize` of the stage) to be copied.
+ * 
+ * @note Elements are gathered in a batch of the thread, that is pushed (blocking while the queue is full) once it is complete or the thread finishes.
+ */
+void pipeEmit(t_pipe_ctx* ctx, const void* elem);
+
+/**
+ * @brief Emits a value of type `type` (any expression) to the next stage, from inside a callback.
+ */
+#define PIPE_EMIT(ctx, type, value) do { \
+  type _pipeVal = (value);               \
+  pipeEmit((ctx), &_pipeVal);            \
+} while (0)
+
+/**
+ * @brief Function that returns the index of the calling thread inside its stage (from 0 to `nThreads - 1`).
+ * 
+ * @param ctx Context received by the callback.
+ * @return Index of the thread.
+ * 
+ * @note Useful to keep per-thread results without synchronization. If they are updated often, give each thread a slot of its own cache line (e.g. a vector of structures aligned to 64 bytes, indexed by it): neighbouring threads writing a packed vector would keep stealing the same line from each other.
+ */
+int pipeWorker(const t_pipe_ctx* ctx);
+
+/**
+ * @brief Function that reads the counters of a stage, after pipeRun().
+ * 
+ * @param pl Pointer to the pipeline.
+ * @param stage Index of the stage (in the order they were added).
+ * @param stats Pointer to the structure to be filled.
+ * @return 0 in success, -1 if there is no such stage.
+ */
+int pipeStats(const t_pipeline* pl, int stage, t_pipe_stats* stats);
+
+/**
+ * @brief Function that prints the counters and the throughput of every stage.
+ * 
+ * @param pl Pointer to the pipeline.
+ * @param out Stream to which the report is written.
+ */
+void pipeReport(const t_pipeline* pl, FILE* out);
+
+/**
+ * @brief Function that frees a pipeline.
+ * 
+ * @param pl Pointer to the pipeline (`NULL` is accepted).
+ */
+void pipeDestroy(t_pipeline* pl);
\ No newline at end of file
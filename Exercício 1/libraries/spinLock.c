@@ -0,0 +1,117 @@
+#include <limits.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "spinLock.h"
+
+/**
+ * @brief Auxiliar function that parks the calling thread while `*addr` holds `val`.
+ */
+static void futexWait(void* addr, int val){
+  syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+/**
+ * @brief Auxiliar function that wakes up to `n` threads parked on `addr`.
+ */
+static void futexWake(void* addr, int n){
+  syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, n, NULL, NULL, 0);
+}
+
+void spinInit(t_spinlock* lock, t_spin_kind kind){
+  atomic_init(&lock->state, 0);
+  atomic_init(&lock->spins, 0);
+  atomic_init(&lock->next, 0);
+  atomic_init(&lock->serving, 0);
+  atomic_init(&lock->sleepers, 0);
+  lock->kind = kind;
+}
+
+/**
+ * @brief Auxiliar function that acquires a `SPIN_ADAPTIVE` lock.
+ * 
+ * Spins up to twice the current estimate (bounded by `SPIN_MAX`) and moves the estimate 1/8 of the way towards the spins actually needed. If the lock is not acquired by then, the thread parks (state 2 tells the owner someone must be woken).
+ */
+static void adaptiveLock(t_spinlock* lock){
+  int expected = 0;
+  int spins = atomic_load_explicit(&lock->spins, memory_order_relaxed);
+  int maxSpins = spins * 2 + 10 < SPIN_MAX ? spins * 2 + 10 : SPIN_MAX;
+  int n;
+
+  if (atomic_compare_exchange_strong_explicit(&lock->state, &expected, 1, memory_order_acquire, memory_order_relaxed))
+    return;
+
+  for (n = 0; n < maxSpins; n++){
+    cpuRelax();
+    expected = 0;
+    if (atomic_load_explicit(&lock->state, memory_order_relaxed) == 0 &&
+        atomic_compare_exchange_weak_explicit(&lock->state, &expected, 1, memory_order_acquire, memory_order_relaxed))
+      break;
+  }
+  atomic_store_explicit(&lock->spins, spins + (n - spins) / 8, memory_order_relaxed);
+
+  if (n < maxSpins)
+    return;
+
+  while (atomic_exchange_explicit(&lock->state, 2, memory_order_acquire) != 0)
+    futexWait(&lock->state, 2);
+}
+
+/**
+ * @brief Auxiliar function that acquires a `SPIN_TICKET` lock.
+ * 
+ * Takes a ticket and spins until it is served; past `SPIN_MAX` spins (fewer if it is not the next in line), parks until the served ticket changes, and then starts spinning again. Every release that finds parked waiters wakes all of them, as only the owner of the next ticket can proceed.
+ */
+static void ticketLock(t_spinlock* lock){
+  unsigned int ticket = atomic_fetch_add_explicit(&lock->next, 1, memory_order_relaxed);
+  unsigned int serving;
+  int n = 0;
+
+  while ((serving = atomic_load_explicit(&lock->serving, memory_order_acquire)) != ticket){
+    // Only the next in line spins for long: the others would just burn the CPU the owner may need
+    if (n++ < (ticket - serving == 1 ? SPIN_MAX : SPIN_MAX / 16)){
+      cpuRelax();
+      continue;
+    }
+
+    // Announcing the sleeper before re-reading `serving` guarantees the owner either sees it or we see the new ticket
+    atomic_fetch_add(&lock->sleepers, 1);
+    if (atomic_load(&lock->serving) == serving)
+      futexWait(&lock->serving, (int)serving);
+    atomic_fetch_sub(&lock->sleepers, 1);
+
+    // The queue moved: spinning again (for long, if now next in line) lets the following handover happen without a syscall
+    n = 0;
+  }
+}
+
+void spinLock(t_spinlock* lock){
+  if (lock->kind == SPIN_TICKET)
+    ticketLock(lock);
+  else
+    adaptiveLock(lock);
+}
+
+int spinTryLock(t_spinlock* lock){
+  if (lock->kind == SPIN_TICKET){
+    unsigned int serving = atomic_load_explicit(&lock->serving, memory_order_acquire);
+    unsigned int expected = serving;
+
+    return atomic_compare_exchange_strong_explicit(&lock->next, &expected, serving + 1, memory_order_acquire, memory_order_relaxed);
+  }
+  else {
+    int expected = 0;
+
+    return atomic_compare_exchange_strong_explicit(&lock->state, &expected, 1, memory_order_acquire, memory_order_relaxed);
+  }
+}
+
+void spinUnlock(t_spinlock* lock){
+  if (lock->kind == SPIN_TICKET){
+    atomic_fetch_add(&lock->serving, 1);
+    if (atomic_load(&lock->sleepers))
+      futexWake(&lock->serving, INT_MAX);
+  }
+  else if (atomic_exchange_explicit(&lock->state, 0, memory_order_release) == 2)
+    futexWake(&lock->state, 1);
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+/**
+ * @file spinLock.h
+ * @brief Library of spin-then-park locks for short critical sections.
+ * 
+ * Library containing a mutual exclusion lock that spins for a while before parking the thread on a futex, so that very short critical sections (a few instructions) are usually handed over without any system call. Two flavours are provided:
+ * - `SPIN_ADAPTIVE`: the spin budget adapts, per lock, to how long acquisitions have recently taken (like glibc's adaptive mutex), and the lock goes to whoever grabs it first;
+ * - `SPIN_TICKET`: threads are served in arrival order (FIFO), trading some throughput for fairness.
+ * 
+ * @note Both are drop-in replacements for a `pthread_mutex_t` (or a binary `sem_t`) that is not used with condition variables.
+ * 
+ * @warning With more threads than CPUs, `SPIN_TICKET` degrades sharply: the lock can only be handed to the next ticket, which is often not running, so nearly every handover costs context switches. Prefer `SPIN_ADAPTIVE` when oversubscribed.
+ */
+
+#pragma once
+
+#include <stdatomic.h>
+
+#define SPIN_MAX 1000 /**< Maximum number of spins before parking. */
+
+/**
+ * @brief Macro that tells the CPU the thread is spinning (saves power and frees the sibling hardware thread).
+ */
+#if defined(__x86_64__) || defined(__i386__)
+#define cpuRelax() __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define cpuRelax() __asm__ __volatile__("yield")
+#else
+#define cpuRelax() ((void)0)
+#endif
+
+/**
+ * @brief Flavours of lock.
+ */
+typedef enum {
+  SPIN_ADAPTIVE, /**< Adaptive spin, then futex; no ordering among the waiters. */
+  SPIN_TICKET    /**< FIFO ticket lock: spin, then futex. */
+} t_spin_kind;
+
+/**
+ * @brief Structure of a spin-then-park lock.
+ * 
+ * @note It occupies a cache line of its own, so that spinning on it does not disturb neighbouring data.
+ */
+typedef struct {
+  _Alignas(64) atomic_int state; /**< `SPIN_ADAPTIVE`: 0 if free, 1 if locked, 2 if locked with parked waiters. */
+  atomic_int spins;              /**< `SPIN_ADAPTIVE`: current estimate of the spins needed to acquire. */
+  atomic_uint next;              /**< `SPIN_TICKET`: next ticket to be handed out. */
+  atomic_uint serving;           /**< `SPIN_TICKET`: ticket that owns the lock. */
+  atomic_int sleepers;           /**< `SPIN_TICKET`: number of parked waiters. */
+  t_spin_kind kind;              /**< Flavour of the lock. */
+} t_spinlock;
+
+/**
+ * @brief Function that initializes a lock (unlocked).
+ * 
+ * @param lock Lock to be initialized.
+ * @param kind Flavour of the lock.
+ */
+void spinInit(t_spinlock* lock, t_spin_kind kind);
+
+/**
+ * @brief Function that acquires a lock, spinning and then parking until it is available.
+ * 
+ * @param lock Lock to be acquired.
+ */
+void spinLock(t_spinlock* lock);
+
+/**
+ * @brief Function that tries to acquire a lock without waiting.
+ * 
+ * @param lock Lock to be acquired.
+ * @return 1 if the lock was acquired, 0 otherwise.
+ */
+int spinTryLock(t_spinlock* lock);
+
+/**
+ * @brief Function that releases a lock, waking a parked waiter if there is one.
+ * 
+ * @param lock Lock to be released (held by the calling thread).
+ */
+void spinUnlock(t_spinlock* lock);
\ No newline at end of file
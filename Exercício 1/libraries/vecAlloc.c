@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#include "vecAlloc.h"
+
+#define NODE_MASK_WORDS 16 /**< Number of `unsigned long` words in the node mask (up to 1024 nodes). */
+
+/**
+ * @brief Auxiliar function that rounds a size up to a multiple of `VEC_HUGE_PAGE`.
+ * 
+ * @param size Size, in bytes.
+ * @return Rounded size.
+ */
+static size_t roundHuge(size_t size){
+  return (size + VEC_HUGE_PAGE - 1) & ~(VEC_HUGE_PAGE - 1);
+}
+
+/**
+ * @brief Auxiliar function that reads the online NUMA nodes from `/sys`.
+ * 
+ * @param mask Node mask to be filled (`NODE_MASK_WORDS` words).
+ * @return Number of online nodes (0 if they could not be read).
+ */
+static int readOnlineNodes(unsigned long mask[NODE_MASK_WORDS]){
+  FILE* file = fopen("/sys/devices/system/node/online", "r");
+  int first, last, nNodes = 0;
+  char sep;
+
+  for (int i = 0; i < NODE_MASK_WORDS; i++)
+    mask[i] = 0;
+
+  if (!file)
+    return 0;
+
+  // The file holds a list of ranges, like "0-1,4"
+  while (fscanf(file, "%d", &first) == 1){
+    last = first;
+    if (fscanf(file, "%c", &sep) == 1 && sep == '-'){
+      if (fscanf(file, "%d", &last) != 1)
+        break;
+      if (fscanf(file, "%c", &sep) != 1)
+        sep = '\n';
+    }
+
+    for (int node = first; node <= last && node < NODE_MASK_WORDS * 8 * (int)sizeof(unsigned long); node++){
+      mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+      nNodes++;
+    }
+
+    if (sep != ',')
+      break;
+  }
+
+  fclose(file);
+  return nNodes;
+}
+
+void* vecAlloc(size_t size, t_numa_policy policy){
+  size_t len = roundHuge(size ? size : 1);
+  size_t mapLen = len + VEC_HUGE_PAGE; // Slack for aligning the base
+  char* map;
+  char* vec;
+
+  map = (char*)mmap(NULL, mapLen, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (map == MAP_FAILED)
+    return NULL;
+
+  // Keeping only the aligned part of the mapping
+  vec = (char*)(((uintptr_t)map + VEC_HUGE_PAGE - 1) & ~(uintptr_t)(VEC_HUGE_PAGE - 1));
+  if (vec > map)
+    munmap(map, vec - map);
+  if (map + mapLen > vec + len)
+    munmap(vec + len, map + mapLen - (vec + len));
+
+  madvise(vec, len, MADV_HUGEPAGE);
+
+  if (policy == VEC_NUMA_INTERLEAVE){
+    unsigned long mask[NODE_MASK_WORDS];
+
+    if (readOnlineNodes(mask) > 1)
+      syscall(SYS_mbind, vec, len, MPOL_INTERLEAVE, mask, NODE_MASK_WORDS * 8 * sizeof(unsigned long), 0);
+  }
+
+  return vec;
+}
+
+void vecFree(void* vec, size_t size){
+  if (vec)
+    munmap(vec, roundHuge(size ? size : 1));
+}
\ No newline at end of file
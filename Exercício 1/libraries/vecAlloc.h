@@ -0,0 +1,44 @@
+/**
+ * @file vecAlloc.h
+ * @brief Library of allocation functions for big vectors.
+ * 
+ * Library containing functions that allocate vectors aligned to huge pages (2 MiB), asking the kernel to back them with transparent huge pages, and choosing how their pages are spread over the NUMA nodes of the host.
+ * 
+ * @sa See concZero() (in concGenerics.h) for the function that places the pages of a `VEC_NUMA_FIRST_TOUCH` vector.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#define VEC_HUGE_PAGE (2UL << 20) /**< Size, in bytes, of a huge page (and alignment of the allocated vectors). */
+
+/**
+ * @brief Placement policies of the pages of a vector over the NUMA nodes.
+ */
+typedef enum {
+  VEC_NUMA_FIRST_TOUCH, /**< Each page lands on the node of the thread that writes it first (kernel default). */
+  VEC_NUMA_INTERLEAVE   /**< Pages are spread, round-robin, over every online node. */
+} t_numa_policy;
+
+/**
+ * @brief Function that allocates a vector aligned to a huge page.
+ * 
+ * @param size Size, in bytes, of the vector.
+ * @param policy Placement policy of the pages of the vector.
+ * @return Base pointer of the vector, `NULL` if allocation failed.
+ * 
+ * @note The memory is zeroed, but its pages are only materialized when first written. With `VEC_NUMA_FIRST_TOUCH`, write it first with concZero(), using the same number of threads the vector will be processed with, so that each worker gets the pages it processes on its own node.
+ * @note Failing to get huge pages or to apply the NUMA policy (e.g. kernels without support) is not an error: the vector is still returned, backed by regular pages.
+ * 
+ * @warning The vector must be freed with vecFree(), never with `free()`.
+ */
+void* vecAlloc(size_t size, t_numa_policy policy);
+
+/**
+ * @brief Function that frees a vector allocated by vecAlloc().
+ * 
+ * @param vec Base pointer of the vector (`NULL` is accepted).
+ * @param size Size, in bytes, passed to vecAlloc().
+ */
+void vecFree(void* vec, size_t size);
\ No newline at end of file
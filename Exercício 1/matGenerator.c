@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "timer.h"
+#include "vecAlloc.h"
+
+#define DEFAULT_MIN -10
+#define DEFAULT_MAX 10
+
+/**
+ * @brief Function that generates a random float in [`min`,`max`].
+ * 
+ * @return Float value from `min` to `max`.
+ */
+float randFloatInterval(float min, float max){
+  return ((float)rand()) / RAND_MAX * (max - min) + min;
+}
+
+/**
+ * @brief Function that computes two checksums of the product `A * B` without computing the product itself.
+ * 
+ * With `C = A * B`, the plain sum of `C` is the sum, over `p`, of (sum of column `p` of `A`) times (sum of row `p` of `B`), and the sum of `C[i][j]` weighted by `(i+1)*(j+1)` follows the same way with weighted column and row sums. Both take O(m*k + k*n) operations, in `double`, so that the reference is much more precise than the product being checked. The weighted one catches swapped rows or columns, which the plain sum does not.
+ * 
+ * @param A Base pointer of the `m` x `k` matrix (row-major).
+ * @param B Base pointer of the `k` x `n` matrix (row-major).
+ * @param sum Pointer to where the plain sum of `C` is to be written.
+ * @param weighted Pointer to where the weighted sum of `C` is to be written.
+ * @param bound Pointer to where the plain sum of `|A| * |B|` (the scale of the rounding errors) is to be written.
+ */
+void productChecksums(const float* A, const float* B, int m, int n, int k, double* sum, double* weighted, double* bound){
+  *sum = *weighted = *bound = 0;
+
+  for (int p = 0; p < k; p++){
+    double colA = 0, colAw = 0, colAbs = 0, rowB = 0, rowBw = 0, rowBabs = 0;
+
+    for (int i = 0; i < m; i++){
+      colA += A[(size_t)i * k + p];
+      colAw += (i + 1.0) * A[(size_t)i * k + p];
+      colAbs += A[(size_t)i * k + p] < 0 ? -A[(size_t)i * k + p] : A[(size_t)i * k + p];
+    }
+    for (int j = 0; j < n; j++){
+      rowB += B[(size_t)p * n + j];
+      rowBw += (j + 1.0) * B[(size_t)p * n + j];
+      rowBabs += B[(size_t)p * n + j] < 0 ? -B[(size_t)p * n + j] : B[(size_t)p * n + j];
+    }
+
+    *sum += colA * rowB;
+    *weighted += colAw * rowBw;
+    *bound += colAbs * rowBabs;
+  }
+}
+
+int main(int argc, char* argv[]){
+  FILE* bin;
+  float* A;
+  float* B;
+  int m, n, k;
+  size_t sizeA, sizeB;
+  double checksums[3]; // Plain sum, weighted sum and error scale of the product
+  const char* filePath;
+  float min = DEFAULT_MIN, max = DEFAULT_MAX;
+  char flagPrint = 0;
+  double begin, end;
+
+  srand(time(NULL));
+
+  if (argc < 5){
+    printf("To few arguments passed to program! Try %s [rows_A (m)] [cols_A = rows_B (k)] [cols_B (n)] [file_path] [print_result? (OPTIONAL)] [min_val (OPTIONAL)] [max_val (OPTIONAL)]\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+
+  m = atoi(argv[1]);
+  k = atoi(argv[2]);
+  n = atoi(argv[3]);
+  filePath = argv[4];
+
+  if (m <= 0 || k <= 0 || n <= 0){
+    printf("ERROR: Invalid dimensions %d x %d x %d!\n", m, k, n);
+    exit(EXIT_FAILURE);
+  }
+
+  if (argc > 5)
+    flagPrint = atoi(argv[5]);
+  if (argc > 6)
+    min = atof(argv[6]);
+  if (argc > 7)
+    max = atof(argv[7]);
+
+  sizeA = (size_t)m * k * sizeof(float);
+  sizeB = (size_t)k * n * sizeof(float);
+
+  A = (float*)vecAlloc(sizeA, VEC_NUMA_INTERLEAVE);
+  if (!A){
+    printf("\nERROR: Failure in allocating memory for matrix A!\n");
+    exit(EXIT_FAILURE);
+  }
+
+  B = (float*)vecAlloc(sizeB, VEC_NUMA_INTERLEAVE);
+  if (!B){
+    printf("\nERROR: Failure in allocating memory for matrix B!\n");
+    vecFree(A, sizeA);
+    exit(EXIT_FAILURE);
+  }
+
+  for (size_t i = 0; i < (size_t)m * k; i++)
+    A[i] = randFloatInterval(min, max);
+  for (size_t i = 0; i < (size_t)k * n; i++)
+    B[i] = randFloatInterval(min, max);
+
+  GET_TIME(begin);
+  productChecksums(A, B, m, n, k, &checksums[0], &checksums[1], &checksums[2]);
+  GET_TIME(end);
+
+  if (flagPrint){
+    printf("Matrix A:\n");
+    for (int i = 0; i < m; i++){
+      for (int p = 0; p < k; p++)
+        printf(" %f ", A[(size_t)i * k + p]);
+      putchar('\n');
+    }
+    printf("Matrix B:\n");
+    for (int p = 0; p < k; p++){
+      for (int j = 0; j < n; j++)
+        printf(" %f ", B[(size_t)p * n + j]);
+      putchar('\n');
+    }
+    printf("Checksums of A * B: %lf (plain), %lf (weighted)\n", checksums[0], checksums[1]);
+  }
+
+  if (!(bin = fopen(filePath, "w"))){
+    printf("ERROR: Could not save the results!\n");
+    vecFree(A, sizeA);
+    vecFree(B, sizeB);
+    exit(EXIT_FAILURE);
+  }
+
+  // Layout: m, k and n (`int`s), A and B (row-major `float`s) and the checksums of the product (`double`s)
+  if (fwrite(&m, sizeof(int), 1, bin) != 1 || fwrite(&k, sizeof(int), 1, bin) != 1 || fwrite(&n, sizeof(int), 1, bin) != 1
+      || fwrite(A, sizeof(float), (size_t)m * k, bin) != (size_t)m * k
+      || fwrite(B, sizeof(float), (size_t)k * n, bin) != (size_t)k * n
+      || fwrite(checksums, sizeof(double), 3, bin) != 3){
+    printf("ERROR: Error in writing the matrices in binary!\n");
+    fclose(bin);
+    vecFree(A, sizeA);
+    vecFree(B, sizeB);
+    exit(EXIT_FAILURE);
+  }
+
+  printf("Writing in %s was successful!\n", filePath);
+  printf("Time elapsed to compute the checksums of the product: %lf s\n", end-begin);
+
+  fclose(bin);
+  vecFree(A, sizeA);
+  vecFree(B, sizeB);
+
+  return 0;
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "exceptions.h"
+#include "concGenerics.h"
+
+void twice(void* modVal, const void* baseVal){
+  long long n = *(int*)baseVal;
+  long long* mod = (long long*)modVal;
+  *mod = 2 * n;
+}
+
+void add(void* destVal, const void* elemVal){
+  long long n = *(long long*)elemVal;
+  long long* dest = (long long*)destVal;
+  *dest += n;
+}
+
+int main(int argc, char* argv[]){
+  int len;
+  int nWorkers;
+  int* enumeration;
+  long long* doubled;
+  long long accumulation = 0;
+  long long expected = 0;
+  long polls = 0;
+  t_conc_future* mapped;
+  t_conc_future* reduced;
+  char flagPrint = 0;
+
+  if (argc < 3){
+    printf("To few arguments passed to program! Try %s [vec_length] [n_threads] [print_result? (OPTIONAL)]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  len = atoi(argv[1]);
+  nWorkers = atoi(argv[2]);
+
+  if (argc > 3)
+    flagPrint = atoi(argv[3]);
+
+  enumeration = (int*)calloc(len, sizeof(int));
+  checkMalloc(enumeration);
+
+  doubled = (long long*)calloc(len, sizeof(long long));
+  checkMalloc(doubled);
+
+  concEnum(enumeration, len, nWorkers);
+
+  // The reduction of each segment starts as soon as the matching segment of the map is done
+  mapped = concMapAsync(NULL, doubled, sizeof(long long), enumeration, sizeof(int), len, twice, nWorkers);
+  checkMalloc(mapped);
+  reduced = concReduceAsync(mapped, &accumulation, doubled, sizeof(long long), len, add, nWorkers);
+  checkMalloc(reduced);
+
+  // The caller is free to do other work meanwhile
+  for (int i = 0; i < len; i++)
+    expected += 2LL * i;
+
+  while (!concTest(reduced))
+    polls++;
+
+  concWait(reduced);
+  concFutureDestroy(mapped);
+  concFutureDestroy(reduced);
+
+  if (flagPrint){
+    printf("Mapped vector:");
+    for (int i = 0; i < len; i++)
+      printf(" %lld ", doubled[i]);
+    putchar('\n');
+  }
+
+  printf("Reduced value: %lld (expected %lld) after %ld polls\n", accumulation, expected, polls);
+
+  free(enumeration);
+  free(doubled);
+
+  return accumulation == expected ? EXIT_SUCCESS : EXIT_FAILURE;
+}
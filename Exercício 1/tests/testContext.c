@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "exceptions.h"
+#include "concGenerics.h"
+
+/**
+ * @brief Adds as `unsigned int`, so that long enumerations wrap around (instead of overflowing) deterministically.
+ */
+void add(void* destVal, const void* elemVal){
+  unsigned int n = *(unsigned int*)elemVal;
+  unsigned int* dest = (unsigned int*)destVal;
+  *dest += n;
+}
+
+int main(int argc, char* argv[]){
+  int len;
+  int nWorkers;
+  int nRounds = 3;
+  int* enumeration;
+  unsigned int accumulation;
+  unsigned int expected;
+  long firstAllocs = 0;
+  int failures = 0;
+  t_conc_ctx* ctx;
+  t_conc_stats stats;
+  char flagPrint = 0;
+
+  if (argc < 3){
+    printf("To few arguments passed to program! Try %s [vec_length] [n_threads] [print_result? (OPTIONAL)]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  len = atoi(argv[1]);
+  nWorkers = atoi(argv[2]);
+
+  if (argc > 3)
+    flagPrint = atoi(argv[3]);
+
+  expected = (unsigned int)((unsigned long long)len * (len - 1) / 2);
+
+  ctx = concCtxCreate(nWorkers, sizeof(int), 0);
+  checkMalloc(ctx);
+
+  for (int round = 0; round < nRounds; round++){
+    // The first round grows the arena, the following ones must not allocate at all
+    enumeration = (int*)concCtxAlloc(ctx, len * sizeof(int));
+    checkMalloc(enumeration);
+
+    accumulation = 0;
+    failures += concEnumCtx(ctx, enumeration, len, nWorkers) != EXIT_SUCCESS;
+    failures += concReduceCtx(ctx, &accumulation, enumeration, sizeof(int), len, add, nWorkers) != EXIT_SUCCESS;
+    failures += accumulation != expected;
+
+    if (flagPrint){
+      printf("Vector:");
+      for (int i = 0; i < len; i++)
+        printf(" %d ", enumeration[i]);
+      putchar('\n');
+    }
+
+    concCtxReset(ctx);
+    concCtxStats(ctx, &stats);
+    printf("Round %d) Reduced value: %u (expected %u) | Allocations so far: %ld (in %ld calls)\n", round, accumulation, expected, stats.allocs, stats.calls);
+
+    if (!round)
+      firstAllocs = stats.allocs;
+    else
+      failures += stats.allocs != firstAllocs;
+  }
+
+  printf("Failed checks: %d\n", failures);
+
+  concCtxDestroy(ctx);
+
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,80 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "exceptions.h"
+#include "concGenerics.h"
+#include "concGemm.h"
+
+/**
+ * @brief Naive matrix product, one dot product per element, used as reference.
+ */
+void naiveGemm(float* C, const float* A, const float* B, int m, int n, int k){
+  for (int i = 0; i < m; i++)
+    for (int j = 0; j < n; j++){
+      double accum = 0;
+      for (int p = 0; p < k; p++)
+        accum += (double)A[i * k + p] * B[p * n + j];
+      C[i * n + j] = (float)accum;
+    }
+}
+
+int main(int argc, char* argv[]){
+  int m, n, k;
+  int nWorkers;
+  float *A, *B, *C, *ref;
+  double maxError = 0;
+  char flagPrint = 0;
+
+  if (argc < 5){
+    printf("To few arguments passed to program! Try %s [m] [n] [k] [n_threads] [print_result? (OPTIONAL)]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  m = atoi(argv[1]);
+  n = atoi(argv[2]);
+  k = atoi(argv[3]);
+  nWorkers = atoi(argv[4]);
+
+  if (argc > 5)
+    flagPrint = atoi(argv[5]);
+
+  A = (float*)malloc((size_t)m * k * sizeof(float));
+  checkMalloc(A);
+  B = (float*)malloc((size_t)k * n * sizeof(float));
+  checkMalloc(B);
+  C = (float*)malloc((size_t)m * n * sizeof(float));
+  checkMalloc(C);
+  ref = (float*)malloc((size_t)m * n * sizeof(float));
+  checkMalloc(ref);
+
+  // Small integers: every partial sum is exact in `float`, so the products must match exactly
+  for (int i = 0; i < m * k; i++)
+    A[i] = (float)(i % 7 - 3);
+  for (int i = 0; i < k * n; i++)
+    B[i] = (float)(i % 5 - 2);
+
+  concGemm(C, A, B, m, n, k, nWorkers);
+  naiveGemm(ref, A, B, m, n, k);
+
+  for (int i = 0; i < m * n; i++)
+    if (fabs(C[i] - ref[i]) > maxError)
+      maxError = fabs(C[i] - ref[i]);
+
+  if (flagPrint){
+    printf("Product:\n");
+    for (int i = 0; i < m; i++){
+      for (int j = 0; j < n; j++)
+        printf(" %g ", C[i * n + j]);
+      putchar('\n');
+    }
+  }
+
+  printf("Maximum error against the naive product: %g\n", maxError);
+
+  free(A);
+  free(B);
+  free(C);
+  free(ref);
+
+  return maxError == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include "exceptions.h"
+#include "concGenerics.h"
+
+int nBins;
+
+/**
+ * @brief Key that scatters the enumeration over the bins (consecutive elements fall on distant bins).
+ */
+int scatter(const void* elemVal){
+  return (int)((unsigned int)*(int*)elemVal * 2654435761u % (unsigned int)nBins);
+}
+
+void max(void* destVal, const void* elemVal){
+  int n = *(int*)elemVal;
+  int* dest = (int*)destVal;
+  if (n > *dest)
+    *dest = n;
+}
+
+int main(int argc, char* argv[]){
+  int len;
+  int nWorkers;
+  int* enumeration;
+  long long *bins, *refBins;
+  int *maxs, *refMaxs;
+  int mismatches = 0;
+  char flagPrint = 0;
+
+  if (argc < 4){
+    printf("To few arguments passed to program! Try %s [vec_length] [n_threads] [n_bins] [print_result? (OPTIONAL)]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  len = atoi(argv[1]);
+  nWorkers = atoi(argv[2]);
+  nBins = atoi(argv[3]);
+
+  if (argc > 4)
+    flagPrint = atoi(argv[4]);
+
+  enumeration = (int*)calloc(len, sizeof(int));
+  checkMalloc(enumeration);
+  bins = (long long*)calloc(nBins, sizeof(long long));
+  checkMalloc(bins);
+  refBins = (long long*)calloc(nBins, sizeof(long long));
+  checkMalloc(refBins);
+  maxs = (int*)malloc(nBins * sizeof(int));
+  checkMalloc(maxs);
+  refMaxs = (int*)malloc(nBins * sizeof(int));
+  checkMalloc(refMaxs);
+
+  concEnum(enumeration, len, nWorkers);
+
+  // Neutral element of `max`, kept by the bins that get no element
+  for (int i = 0; i < nBins; i++)
+    maxs[i] = refMaxs[i] = INT_MIN;
+
+  concHistogram(bins, nBins, enumeration, sizeof(int), len, scatter, nWorkers);
+  concReduceByKey(maxs, nBins, enumeration, sizeof(int), len, scatter, max, nWorkers);
+
+  for (int i = 0; i < len; i++){
+    refBins[scatter(&enumeration[i])]++;
+    max(&refMaxs[scatter(&enumeration[i])], &enumeration[i]);
+  }
+
+  for (int i = 0; i < nBins; i++)
+    if (bins[i] != refBins[i] || maxs[i] != refMaxs[i])
+      mismatches++;
+
+  if (flagPrint){
+    printf("Bins:");
+    for (int i = 0; i < nBins; i++)
+      printf(" %lld ", bins[i]);
+    printf("\nMaximum of each bin:");
+    for (int i = 0; i < nBins; i++)
+      printf(" %d ", maxs[i]);
+    putchar('\n');
+  }
+
+  printf("Bins differing from the sequential count: %d\n", mismatches);
+
+  free(enumeration);
+  free(bins);
+  free(refBins);
+  free(maxs);
+  free(refMaxs);
+
+  return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
\ No newline at end of file
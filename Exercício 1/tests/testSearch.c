@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "exceptions.h"
+#include "concGenerics.h"
+
+int target;
+int period; /**< Values of the vector are in [0, period), each one appearing about three times along it. */
+
+void scramble(void* modVal, const void* baseVal){
+  int n = *(int*)baseVal;
+  int* mod = (int*)modVal;
+  *mod = (int)(((long long)n * 31 + 500) % period);
+}
+
+int isTarget(const void* elemVal){
+  return *(int*)elemVal == target;
+}
+
+int inRange(const void* elemVal){
+  return *(int*)elemVal >= 0 && *(int*)elemVal < period;
+}
+
+int isNotTarget(const void* elemVal){
+  return !isTarget(elemVal);
+}
+
+int cmpInt(const void* a, const void* b){
+  return *(int*)a - *(int*)b;
+}
+
+int main(int argc, char* argv[]){
+  int len;
+  int nWorkers;
+  int* vec;
+  int found, any, all, notAll, minIdx, maxIdx, minVal, maxVal;
+  int refFound = -1, refMinIdx = 0, refMaxIdx = 0;
+  int mismatches = 0;
+  char flagPrint = 0;
+
+  if (argc < 4){
+    printf("To few arguments passed to program! Try %s [vec_length] [n_threads] [target] [print_result? (OPTIONAL)]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  len = atoi(argv[1]);
+  nWorkers = atoi(argv[2]);
+  target = atoi(argv[3]);
+  period = len / 3 + 1;
+
+  if (argc > 4)
+    flagPrint = atoi(argv[4]);
+
+  vec = (int*)calloc(len, sizeof(int));
+  checkMalloc(vec);
+
+  concEnum(vec, len, nWorkers);
+  concMap(vec, sizeof(int), vec, sizeof(int), len, scramble, nWorkers);
+
+  concFind(&found, vec, sizeof(int), len, isTarget, nWorkers);
+  concAny(&any, vec, sizeof(int), len, isTarget, nWorkers);
+  concAll(&all, vec, sizeof(int), len, inRange, nWorkers);
+  concAll(&notAll, vec, sizeof(int), len, isNotTarget, nWorkers);
+  concArgMin(&minVal, &minIdx, vec, sizeof(int), len, cmpInt, nWorkers);
+  concArgMax(&maxVal, &maxIdx, vec, sizeof(int), len, cmpInt, nWorkers);
+
+  for (int i = 0; i < len; i++){
+    if (refFound == -1 && isTarget(&vec[i]))
+      refFound = i;
+    if (vec[i] < vec[refMinIdx])
+      refMinIdx = i;
+    if (vec[i] > vec[refMaxIdx])
+      refMaxIdx = i;
+  }
+
+  mismatches += found != refFound;
+  mismatches += any != (refFound != -1);
+  mismatches += all != 1;
+  mismatches += notAll != (refFound == -1);
+  mismatches += minIdx != refMinIdx || minVal != vec[refMinIdx];
+  mismatches += maxIdx != refMaxIdx || maxVal != vec[refMaxIdx];
+
+  if (flagPrint){
+    printf("Vector:");
+    for (int i = 0; i < len; i++)
+      printf(" %d ", vec[i]);
+    putchar('\n');
+  }
+
+  printf("First index of %d: %d (any: %d, none: %d)\n", target, found, any, notAll);
+  printf("Minimum: %d at %d, maximum: %d at %d\n", minVal, minIdx, maxVal, maxIdx);
+  printf("Results differing from the sequential search: %d\n", mismatches);
+
+  free(vec);
+
+  return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
\ No newline at end of file
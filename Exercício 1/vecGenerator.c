@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <time.h>
 #include "timer.h"
+#include "vecAlloc.h"
 
 #define DEFAULT_MIN -10
 #define DEFAULT_MAX 10
@@ -102,16 +103,16 @@ int main(int argc, char* argv[]){
     max = atof(argv[5]);
   }
 
-  vec1 = (float*)calloc(len, sizeof(float));
+  vec1 = (float*)vecAlloc(len * sizeof(float), VEC_NUMA_INTERLEAVE);
   if (!vec1){
     printf("\nERROR: Failure in allocating memory for vector 1!\n");
     exit(EXIT_FAILURE);
   }
 
-  vec2 = (float*)calloc(len, sizeof(float));
+  vec2 = (float*)vecAlloc(len * sizeof(float), VEC_NUMA_INTERLEAVE);
   if (!vec2){
     printf("\nERROR: Failure in allocating memory for vector 2!\n");
-    free(vec1);
+    vecFree(vec1, len * sizeof(float));
     exit(EXIT_FAILURE);
   }
 
@@ -140,32 +141,32 @@ int main(int argc, char* argv[]){
   if (fwrite(&len, sizeof(int), 1, bin) != 1){
     printf("ERROR: Error in writing the length of vectors in binary!\n");
     fclose(bin);
-    free(vec1);
-    free(vec2);
+    vecFree(vec1, len * sizeof(float));
+    vecFree(vec2, len * sizeof(float));
     exit(EXIT_FAILURE);
   }
 
   if (fwrite(vec1, sizeof(float), len, bin) != len){
     printf("ERROR: Error in writing the 1st vector in binary!\n");
     fclose(bin);
-    free(vec1);
-    free(vec2);
+    vecFree(vec1, len * sizeof(float));
+    vecFree(vec2, len * sizeof(float));
     exit(EXIT_FAILURE);
   }
 
   if (fwrite(vec2, sizeof(float), len, bin) != len){
     printf("ERROR: Error in writing the 2nd vector in binary!\n");
     fclose(bin);
-    free(vec1);
-    free(vec2);
+    vecFree(vec1, len * sizeof(float));
+    vecFree(vec2, len * sizeof(float));
     exit(EXIT_FAILURE);
   }
 
   if (fwrite(&dotProd, sizeof(float), 1, bin) != 1){
     printf("ERROR: Error in writing the dot product of vectors in binary!\n");
     fclose(bin);
-    free(vec1);
-    free(vec2);
+    vecFree(vec1, len * sizeof(float));
+    vecFree(vec2, len * sizeof(float));
     exit(EXIT_FAILURE);
   }
 
@@ -173,8 +174,8 @@ int main(int argc, char* argv[]){
   printf("Time elapsed to compute the dot product: %lf s\n", end-begin);
 
   fclose(bin);
-  free(vec1);
-  free(vec2);
+  vecFree(vec1, len * sizeof(float));
+  vecFree(vec2, len * sizeof(float));
 
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,134 @@
+/* Disciplina: Programacao Concorrente */
+/* Codigo: Compara travas em secoes criticas curtas (um incremento): pthread_mutex, semaforo binario, */
+/*         spin adaptativo e ticket (spinLock.h), variando a qtde de threads */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include "affinity.h"
+#include "spinLock.h"
+#include "timer.h"
+
+#define NINCREMENTOS 1000000 //qtde padrao de incrementos feitos por cada thread
+
+//travas comparadas
+typedef enum { TRAVA_MUTEX, TRAVA_SEM, TRAVA_SPIN, TRAVA_TICKET, NTRAVAS } t_trava;
+const char *nomesTravas[NTRAVAS] = {"mutex", "semaforo", "spin", "ticket"};
+
+t_trava trava; //trava em uso
+pthread_mutex_t mutex;
+sem_t sem;
+t_spinlock spin;
+long int contador; //variavel compartilhada protegida pela trava
+long int nincrementos = NINCREMENTOS; //incrementos por thread (passado na linha de comando)
+pthread_barrier_t largada; //faz todas as threads comecarem juntas
+t_affinity afinidade; //politica de fixacao das threads nas CPUs
+
+//funcao executada pelas threads: incrementa o contador dentro da secao critica
+void *tarefa (void *arg) {
+  (void) arg;
+  pthread_barrier_wait(&largada);
+
+  switch (trava) {
+  case TRAVA_MUTEX:
+    for (long int i=0; i<nincrementos; i++) {
+      pthread_mutex_lock(&mutex);
+      contador++;
+      pthread_mutex_unlock(&mutex);
+    }
+    break;
+  case TRAVA_SEM:
+    for (long int i=0; i<nincrementos; i++) {
+      sem_wait(&sem);
+      contador++;
+      sem_post(&sem);
+    }
+    break;
+  default: //spin e ticket
+    for (long int i=0; i<nincrementos; i++) {
+      spinLock(&spin);
+      contador++;
+      spinUnlock(&spin);
+    }
+    break;
+  }
+
+  pthread_exit(NULL);
+}
+
+//executa a carga com 'nthreads' threads e a trava 't' e devolve a vazao (incrementos por segundo)
+double executa (int nthreads, t_trava t) {
+  pthread_t tid[nthreads];
+  pthread_attr_t attr, *attrPtr;
+  double inicio, fim;
+
+  trava = t;
+  contador = 0;
+  pthread_mutex_init(&mutex, NULL);
+  sem_init(&sem, 0, 1);
+  spinInit(&spin, t == TRAVA_TICKET ? SPIN_TICKET : SPIN_ADAPTIVE);
+  pthread_barrier_init(&largada, NULL, nthreads+1);
+
+  for (int i=0; i<nthreads; i++) {
+    attrPtr = affinityAttr(&afinidade, i, &attr);
+    if (pthread_create(&tid[i], attrPtr, tarefa, NULL)) {
+      printf("--ERRO: pthread_create()\n"); exit(-1);
+    }
+    if (attrPtr) pthread_attr_destroy(attrPtr);
+  }
+
+  pthread_barrier_wait(&largada); //libera as threads e comeca a medicao
+  GET_TIME(inicio);
+  for (int i=0; i<nthreads; i++) {
+    if (pthread_join(tid[i], NULL)) {
+      printf("--ERRO: pthread_join()\n"); exit(-1);
+    }
+  }
+  GET_TIME(fim);
+
+  if (contador != nthreads*nincrementos) {
+    printf("--ERRO: trava %s perdeu incrementos (%ld de %ld)\n", nomesTravas[t], contador, nthreads*nincrementos);
+    exit(-1);
+  }
+
+  pthread_barrier_destroy(&largada);
+  sem_destroy(&sem);
+  pthread_mutex_destroy(&mutex);
+
+  return (double)nthreads*nincrementos / (fim - inicio);
+}
+
+//fluxo principal
+int main (int argc, char *argv[]) {
+  int maxThreads;
+
+  //--le e avalia os parametros de entrada
+  if (argc<2) {
+    printf("Digite: %s <numero maximo de threads> [incrementos por thread] [afinidade: none|compact|scatter|physical|lista de CPUs]\n", argv[0]);
+    return 1;
+  }
+  maxThreads = atoi(argv[1]);
+  if (maxThreads <= 0) { printf("--ERRO: numero de threads invalido\n"); return 1; }
+  if (argc>2 && (nincrementos = atol(argv[2])) <= 0) { printf("--ERRO: numero de incrementos invalido\n"); return 1; }
+  if (affinityParse(argc>3 ? argv[3] : "none", &afinidade)) {
+    printf("--ERRO: politica de afinidade invalida\n"); return 1;
+  }
+
+  //--tabela de vazao (milhoes de incrementos por segundo), dobrando as threads ate o maximo
+  printf("%8s", "threads");
+  for (int t=0; t<NTRAVAS; t++) printf(" %10s", nomesTravas[t]);
+  printf("   (Mincr/s)\n");
+
+  for (int n=1; n<=maxThreads; n = (n < maxThreads && n*2 > maxThreads) ? maxThreads : n*2) {
+    printf("%8d", n);
+    for (int t=0; t<NTRAVAS; t++) {
+      printf(" %10.2f", executa(n, t)/1e6);
+      fflush(stdout);
+    }
+    printf("\n");
+  }
+
+  return 0;
+}
\ No newline at end of file
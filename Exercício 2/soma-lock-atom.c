@@ -4,29 +4,199 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <sched.h>
 #include <pthread.h>
+#include "affinity.h"
+#include "timer.h"
+#include "spinLock.h"
+#include "lockProf.h" //com -DLOCKPROF, perfila a disputa pelo mutex e as esperas nas condicoes
 
-long int soma = 0; //variavel compartilhada entre as threads
+#define NINCREMENTOS 100000 //qtde de incrementos feitos por cada thread
+#define MARCO 1000 //a soma e impressa sempre que atinge um multiplo deste valor
+#define LOTE_SHARD 64 //incrementos acumulados no shard da thread antes de publica-los no total
+#define TAM_ANEL 1024 //qtde de multiplos que podem aguardar impressao no anel (potencia de 2)
+#define NBLOCOS 8 //qtde de tamanhos de bloco testados na varredura do modo bloco
+
+//formas de entregar os multiplos para a thread de log (escolhida na linha de comando)
+typedef enum { LOG_BLOQUEANTE, LOG_ANEL, NLOGS } t_log;
+const char *nomesLogs[NLOGS] = {"bloqueante", "anel"};
+
+//backends do contador (escolhido na linha de comando)
+typedef enum { MODO_MUTEX, MODO_SPIN, MODO_TICKET, MODO_ATOMICO, MODO_SHARD, MODO_BLOCO, NMODOS } t_modo;
+const char *nomesModos[NMODOS] = {"mutex", "spin", "ticket", "atomico", "shard", "bloco"};
+
+//tamanhos de bloco testados na varredura do modo bloco
+const long int blocosVarredura[NBLOCOS] = {1, 8, 64, 512, 1000, 4096, 32768, NINCREMENTOS};
+
+//resultado de uma execucao
+typedef struct {
+  t_modo modo; //backend do contador
+  t_log log; //forma de entrega dos multiplos
+  long int bloco; //tamanho do bloco (so no modo bloco)
+  double vazao; //incrementos por segundo
+  double parada; //tempo (somado entre as threads de soma) parado esperando o log
+} t_resultado;
+
+//shard de uma thread, ocupando sozinho uma linha de cache (evita falso compartilhamento)
+typedef struct {
+  _Alignas(64) atomic_long valor; //incrementos ainda nao publicados no total
+} t_shard;
+
+//posicao do anel de multiplos: o k-esimo multiplo (k>=1) ocupa a posicao (k-1)%TAM_ANEL
+typedef struct {
+  _Alignas(64) atomic_long seq; //k quando o k-esimo multiplo esta pronto; k-1 quando a posicao esta livre para ele
+  long int valor; //multiplo guardado
+} t_posAnel;
+
+long int soma = 0; //variavel compartilhada entre as threads (modos mutex, spin e ticket)
+atomic_long somaAtomica; //total compartilhado entre as threads (modos atomico e shard)
+t_shard *shards; //um shard por thread (modo shard)
 pthread_mutex_t mutex; //variavel de lock para exclusao mutua
+t_spinlock trava; //lock de espera ocupada e depois futex (modos spin e ticket)
 pthread_cond_t condSoma, condLog; //variaveis de condicao (para produtores e consumidor)
 int nthreads; //qtde de threads (passada na linha de comando)
 short int logPendente = 0; //flag que indica se ha multiplo pendente para ser impresso
+long int marcoPendente; //multiplo pendente para ser impresso
+t_modo modo; //backend do contador em uso
+long int tamBloco = MARCO; //incrementos reservados por fetch_add no modo bloco
+t_log tipoLog; //forma de entrega dos multiplos em uso
+t_posAnel anel[TAM_ANEL]; //anel sem lock de multiplos pendentes (modo de log anel)
+double *espera; //tempo que cada thread de soma passou parada esperando o log
+t_affinity afinidade; //politica de fixacao das threads nas CPUs (passada na linha de comando)
+
+//insere o multiplo 'valor' no anel, sem lock (so espera se o anel estiver cheio)
+void insereAnel (long int id, long int valor) {
+  long int k = valor/MARCO; //o multiplo define a propria posicao, entao o log le em ordem
+  t_posAnel *pos = &anel[(k-1) % TAM_ANEL];
+  double inicio, fim;
+
+  if (atomic_load_explicit(&pos->seq, memory_order_acquire) != k-1) {
+    GET_TIME(inicio);
+    while (atomic_load_explicit(&pos->seq, memory_order_acquire) != k-1) //log ainda nao leu o multiplo k-TAM_ANEL
+      sched_yield();
+    GET_TIME(fim);
+    espera[id] += fim - inicio;
+  }
+  pos->valor = valor;
+  atomic_store_explicit(&pos->seq, k, memory_order_release);
+}
+
+//espera o multiplo pendente ser impresso (chamada com o mutex travado), contabilizando o tempo parado
+void esperaLog (long int id) {
+  double inicio, fim;
+  if (!logPendente) return;
+  GET_TIME(inicio);
+  while (logPendente) //enquanto houver multiplo a ser impresso...
+    profCondWait(&condSoma, &mutex); //bloqueia a thread atual de soma
+  GET_TIME(fim);
+  espera[id] += fim - inicio;
+}
+
+//entrega um multiplo atingido para a thread de log
+void notificaMarco (long int id, long int valor) {
+  if (tipoLog == LOG_ANEL) {
+    insereAnel(id, valor);
+    return;
+  }
+  profMutexLock(&mutex);
+  esperaLog(id); //bloqueia enquanto houver outro pendente
+  marcoPendente = valor;
+  logPendente = 1;
+  pthread_cond_signal(&condLog);
+  profMutexUnlock(&mutex);
+}
+
+//publica 'qtde' incrementos no total atomico e notifica cada multiplo atravessado
+void publica (long int id, long int qtde) {
+  long int antes = atomic_fetch_add(&somaAtomica, qtde);
+  //cada multiplo em (antes, antes+qtde] pertence a exatamente um fetch_add
+  for (long int m = (antes/MARCO + 1)*MARCO; m <= antes + qtde; m += MARCO)
+    notificaMarco(id, m);
+}
+
+//le o valor do contador (no modo shard, agrega os incrementos ainda nao publicados)
+long int leSoma (void) {
+  long int total;
+  if (modo == MODO_MUTEX || modo == MODO_SPIN || modo == MODO_TICKET) return soma;
+  total = atomic_load(&somaAtomica);
+  if (modo == MODO_SHARD)
+    for (int t=0; t<nthreads; t++)
+      total += atomic_load_explicit(&shards[t].valor, memory_order_relaxed);
+  return total;
+}
 
 //funcao executada pelas threads
 void *ExecutaTarefa (void *arg) {
   long int id = (long int) arg;
   printf("Thread : %ld esta executando...\n", id);
 
-  for (int i=0; i<100000; i++) {
-    pthread_mutex_lock(&mutex);
-    while (logPendente) //enquanto houver multiplo a ser impresso...
-      pthread_cond_wait(&condSoma, &mutex); //bloqueia a thread atual de soma
-    soma++;
-    if (!(soma%1000)){
-      logPendente = 1; //agora ha multiplo para imprimir
-      pthread_cond_signal(&condLog); //sinaliza a thread de impressao
+  switch (modo) {
+  case MODO_MUTEX:
+    for (int i=0; i<NINCREMENTOS; i++) {
+      profMutexLock(&mutex);
+      esperaLog(id); //no log bloqueante, espera enquanto houver multiplo a ser impresso
+      soma++;
+      if (!(soma%MARCO)){
+        if (tipoLog == LOG_ANEL)
+          insereAnel(id, soma); //o log imprime depois, sem parar as threads de soma
+        else {
+          marcoPendente = soma;
+          logPendente = 1; //agora ha multiplo para imprimir
+          pthread_cond_signal(&condLog); //sinaliza a thread de impressao
+        }
+      }
+      profMutexUnlock(&mutex);
     }
-    pthread_mutex_unlock(&mutex);
+    break;
+
+  case MODO_SPIN:
+  case MODO_TICKET:
+    //secao critica so com o incremento: o multiplo e entregue fora dela, como no modo atomico
+    for (int i=0; i<NINCREMENTOS; i++) {
+      long int v;
+      spinLock(&trava);
+      v = ++soma;
+      spinUnlock(&trava);
+      if (!(v%MARCO))
+        notificaMarco(id, v);
+    }
+    break;
+
+  case MODO_ATOMICO:
+    for (int i=0; i<NINCREMENTOS; i++) {
+      //o valor devolvido e unico, entao so uma thread ve cada multiplo
+      long int v = atomic_fetch_add(&somaAtomica, 1) + 1;
+      if (!(v%MARCO))
+        notificaMarco(id, v);
+    }
+    break;
+
+  case MODO_SHARD:
+    for (int i=0; i<NINCREMENTOS; i++) {
+      //so a propria thread escreve no seu shard: load+store dispensa operacao atomica de leitura-escrita
+      long int v = atomic_load_explicit(&shards[id].valor, memory_order_relaxed) + 1;
+      if (v == LOTE_SHARD) {
+        atomic_store_explicit(&shards[id].valor, 0, memory_order_relaxed);
+        publica(id, LOTE_SHARD);
+      }
+      else
+        atomic_store_explicit(&shards[id].valor, v, memory_order_relaxed);
+    }
+    //publica o que sobrou no shard
+    publica(id, atomic_exchange_explicit(&shards[id].valor, 0, memory_order_relaxed));
+    break;
+
+  case MODO_BLOCO:
+    //reserva blocos inteiros de incrementos com um unico fetch_add; 'publica' so notifica
+    //o log se o bloco reservado atravessar um multiplo, o que e detectado localmente
+    for (long int feitos=0; feitos<NINCREMENTOS; feitos += tamBloco)
+      publica(id, feitos + tamBloco <= NINCREMENTOS ? tamBloco : NINCREMENTOS - feitos);
+    break;
+
+  default:
+    break;
   }
 
   printf("Thread : %ld terminou!\n", id);
@@ -37,34 +207,130 @@ void *ExecutaTarefa (void *arg) {
 void *extra (void *args) {
   printf("Extra : esta executando...\n");
 
-  for (int i = 0; i < nthreads*100; i++){
-    pthread_mutex_lock(&mutex);
-    if (!logPendente) //se nao ha nada para imprimir...
-      pthread_cond_wait(&condLog, &mutex); //bloqueia ate ser requisitado
-    printf("soma = %ld\n", soma);
+  if (tipoLog == LOG_ANEL) {
+    //drena o anel em ordem: o k-esimo multiplo esta sempre na posicao (k-1)%TAM_ANEL
+    for (long int k = 1; k <= (long int)nthreads*(NINCREMENTOS/MARCO); k++) {
+      t_posAnel *pos = &anel[(k-1) % TAM_ANEL];
+      while (atomic_load_explicit(&pos->seq, memory_order_acquire) != k) //multiplo k ainda nao chegou
+        sched_yield();
+      printf("soma = %ld\n", pos->valor);
+      atomic_store_explicit(&pos->seq, k-1 + TAM_ANEL, memory_order_release); //libera a posicao para o multiplo k+TAM_ANEL
+    }
+    printf("Extra : terminou!\n");
+    pthread_exit(NULL);
+  }
+
+  for (int i = 0; i < nthreads*(NINCREMENTOS/MARCO); i++){
+    profMutexLock(&mutex);
+    while (!logPendente) //se nao ha nada para imprimir...
+      profCondWait(&condLog, &mutex); //bloqueia ate ser requisitado
+    printf("soma = %ld\n", marcoPendente);
     logPendente = 0; //ja imprimi o que era necessario
     pthread_cond_broadcast(&condSoma); //libero todas as threads de soma bloqueadas
-    pthread_mutex_unlock(&mutex);
+    profMutexUnlock(&mutex);
   }
 
   printf("Extra : terminou!\n");
   pthread_exit(NULL);
 }
 
+//executa a carga completa com o backend 'modo' e devolve a vazao (incrementos por segundo)
+double executa (pthread_t *tid, double *paradas) {
+  pthread_attr_t attr, *attrPtr; //atributos das threads (fixacao em CPU)
+  double inicio, fim;
+
+  //--reinicia o estado compartilhado
+  soma = 0;
+  spinInit(&trava, modo == MODO_TICKET ? SPIN_TICKET : SPIN_ADAPTIVE);
+  atomic_store(&somaAtomica, 0);
+  for (int t=0; t<nthreads; t++) atomic_store(&shards[t].valor, 0);
+  logPendente = 0;
+  for (int i=0; i<TAM_ANEL; i++) atomic_store(&anel[i].seq, i); //posicao i livre para o multiplo i+1
+  for (int t=0; t<nthreads; t++) espera[t] = 0;
+
+  GET_TIME(inicio);
+
+  //--cria as threads
+  for(long int t=0; t<nthreads; t++) {
+    attrPtr = affinityAttr(&afinidade, t, &attr); //a thread t vai para a t-esima CPU da politica
+    if (pthread_create(&tid[t], attrPtr, ExecutaTarefa, (void *)t)) {
+      printf("--ERRO: pthread_create()\n"); exit(-1);
+    }
+    if (attrPtr) pthread_attr_destroy(attrPtr);
+  }
+
+  //--cria thread de log
+  attrPtr = affinityAttr(&afinidade, nthreads, &attr);
+  if (pthread_create(&tid[nthreads], attrPtr, extra, NULL)) {
+    printf("--ERRO: pthread_create()\n"); exit(-1);
+  }
+  if (attrPtr) pthread_attr_destroy(attrPtr);
+
+  //--espera as threads de soma terminarem (fim da medicao)...
+  for (int t=0; t<nthreads; t++) {
+    if (pthread_join(tid[t], NULL)) {
+      printf("--ERRO: pthread_join() \n"); exit(-1);
+    }
+  }
+  GET_TIME(fim);
+
+  //--...e depois a de log
+  if (pthread_join(tid[nthreads], NULL)) {
+    printf("--ERRO: pthread_join() \n"); exit(-1);
+  }
+
+  printf("Valor de 'soma' = %ld\n", leSoma());
+
+  *paradas = 0;
+  for (int t=0; t<nthreads; t++) *paradas += espera[t];
+
+  return (double)nthreads*NINCREMENTOS / (fim - inicio);
+}
+
+//le a escolha 'arg' dentre 'n' nomes ("todos" escolhe todos); devolve 1 se for invalida
+int escolhe (const char *arg, const char **nomes, int n, int *primeiro, int *ultimo) {
+  if (!strcmp(arg, "todos")) { *primeiro = 0; *ultimo = n-1; return 0; }
+  for (*primeiro=0; *primeiro<n && strcmp(arg, nomes[*primeiro]); (*primeiro)++);
+  *ultimo = *primeiro;
+  return *primeiro == n;
+}
+
 //fluxo principal
 int main(int argc, char *argv[]) {
   pthread_t *tid; //identificadores das threads no sistema
+  t_resultado resultados[NLOGS*(NMODOS-1+NBLOCOS)]; //resultado de cada execucao
+  int nresultados = 0;
+  int varre = 0; //flag que indica se o modo bloco varre varios tamanhos de bloco
+  int primeiro, ultimo; //intervalo de modos a executar
+  int primeiroLog, ultimoLog; //intervalo de formas de log a executar
 
   //--le e avalia os parametros de entrada
   if(argc<2) {
-    printf("Digite: %s <numero de threads>\n", argv[0]);
+    printf("Digite: %s <numero de threads> [afinidade: none|compact|scatter|physical|lista de CPUs] [modo: mutex|spin|ticket|atomico|shard|bloco|todos] [log: bloqueante|anel|todos] [tamanho do bloco: n|varre]\n", argv[0]);
     return 1;
   }
   nthreads = atoi(argv[1]);
+  if (affinityParse(argc>2 ? argv[2] : "none", &afinidade)) {
+    printf("--ERRO: politica de afinidade invalida\n"); return 1;
+  }
+  if (escolhe(argc>3 ? argv[3] : nomesModos[MODO_MUTEX], nomesModos, NMODOS, &primeiro, &ultimo)) {
+    printf("--ERRO: modo invalido\n"); return 1;
+  }
+  if (escolhe(argc>4 ? argv[4] : nomesLogs[LOG_BLOQUEANTE], nomesLogs, NLOGS, &primeiroLog, &ultimoLog)) {
+    printf("--ERRO: log invalido\n"); return 1;
+  }
+  if (argc>5) {
+    if (!strcmp(argv[5], "varre")) varre = 1;
+    else if ((tamBloco = atol(argv[5])) <= 0) { printf("--ERRO: tamanho de bloco invalido\n"); return 1; }
+  }
 
   //--aloca as estruturas
   tid = (pthread_t*) malloc(sizeof(pthread_t)*(nthreads+1));
   if(tid==NULL) {puts("ERRO--malloc"); return 2;}
+  shards = (t_shard*) aligned_alloc(64, sizeof(t_shard)*nthreads);
+  if(shards==NULL) {puts("ERRO--malloc"); return 2;}
+  espera = (double*) malloc(sizeof(double)*nthreads);
+  if(espera==NULL) {puts("ERRO--malloc"); return 2;}
 
   //--inicilaiza o mutex (lock de exclusao mutua)
   pthread_mutex_init(&mutex, NULL);
@@ -73,33 +339,39 @@ int main(int argc, char *argv[]) {
   pthread_cond_init(&condSoma, NULL);
   pthread_cond_init(&condLog, NULL);
 
-  //--cria as threads
-  for(long int t=0; t<nthreads; t++) {
-    if (pthread_create(&tid[t], NULL, ExecutaTarefa, (void *)t)) {
-      printf("--ERRO: pthread_create()\n"); exit(-1);
+  //--executa cada modo pedido, com cada forma de log pedida
+  for (int l=primeiroLog; l<=ultimoLog; l++) {
+    tipoLog = l;
+    for (int m=primeiro; m<=ultimo; m++) {
+      modo = m;
+      for (int b=0; b < (m == MODO_BLOCO && varre ? NBLOCOS : 1); b++) {
+        t_resultado *r = &resultados[nresultados++];
+        if (varre) tamBloco = blocosVarredura[b];
+        r->modo = m; r->log = l; r->bloco = tamBloco;
+        r->vazao = executa(tid, &r->parada);
+      }
     }
   }
 
-  //--cria thread de log
-  if (pthread_create(&tid[nthreads], NULL, extra, NULL)) {
-    printf("--ERRO: pthread_create()\n"); exit(-1);
-  }
-
-  //--espera todas as threads terminarem
-  for (int t=0; t<nthreads+1; t++) {
-    if (pthread_join(tid[t], NULL)) {
-      printf("--ERRO: pthread_join() \n"); exit(-1); 
-    } 
-  } 
-
   //--finaliza o mutex
   pthread_mutex_destroy(&mutex);
 
   //--finaliza os conds
   pthread_cond_destroy(&condSoma);
   pthread_cond_destroy(&condLog);
-  
-  printf("Valor de 'soma' = %ld\n", soma);
+
+  //--relata a vazao de cada modo e quanto as threads de soma ficaram paradas pelo log
+  for (int i=0; i<nresultados; i++) {
+    t_resultado *r = &resultados[i];
+    printf("Modo %s", nomesModos[r->modo]);
+    if (r->modo == MODO_BLOCO) printf(" (bloco de %ld)", r->bloco);
+    printf(", log %s: %.0f incrementos/s, threads de soma paradas por %lf s\n",
+           nomesLogs[r->log], r->vazao, r->parada);
+  }
+
+  free(tid);
+  free(shards);
+  free(espera);
 
    return 0;
 }
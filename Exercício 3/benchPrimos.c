@@ -0,0 +1,261 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "timer.h"
+
+#define MAX_LISTA 64 // Máximo de valores em cada lista da varredura
+#define MAX_ARGS 64 // Máximo de argumentos passados a cada execução
+#define MAX_SAIDA (1 << 20) // Máximo de bytes lidos da saída de cada execução
+
+// Resultado de uma execução de um dos programas
+typedef struct {
+  double tempo; // Tempo de parede do processo (s)
+  long long int total; // Contagem de primos informada
+  long long int minThread, maxThread; // Menor e maior contagem por thread (contPrimos)
+  double mediaThread; // Contagem média por thread (contPrimos)
+} t_execucao;
+
+// Lê uma lista de inteiros separados por vírgula, como "1,2,4"; devolve quantos foram lidos, -1 se malformada
+int leLista(const char* texto, long long int* valores){
+  int n = 0;
+  char* fim;
+
+  while (*texto && n < MAX_LISTA){
+    valores[n++] = strtoll(texto, &fim, 10);
+    if (fim == texto || valores[n - 1] <= 0)
+      return -1;
+    texto = *fim == ',' ? fim + 1 : fim;
+    if (*fim && *fim != ',')
+      return -1;
+  }
+  return n;
+}
+
+// Acrescenta ao vetor de argumentos as palavras (separadas por espaço) de `texto`
+void acrescentaPalavras(char** args, int* nArgs, char* texto){
+  for (char* palavra = strtok(texto, " "); palavra && *nArgs < MAX_ARGS - 1; palavra = strtok(NULL, " "))
+    args[(*nArgs)++] = palavra;
+}
+
+// Executa `args` (args[0] é o caminho do binário), guardando a saída em `saida`; devolve o tempo de parede,
+// ou -1 se o programa não pôde ser executado ou terminou com erro
+double executa(char** args, char* saida){
+  int canal[2], estado;
+  size_t lidos = 0;
+  ssize_t n;
+  pid_t pid;
+  double inicio, fim;
+
+  if (pipe(canal))
+    return -1;
+
+  GET_TIME(inicio);
+  if ((pid = fork()) < 0)
+    return -1;
+  if (pid == 0){
+    dup2(canal[1], STDOUT_FILENO);
+    close(canal[0]);
+    close(canal[1]);
+    execv(args[0], args);
+    _exit(127);
+  }
+
+  close(canal[1]);
+  while ((n = read(canal[0], saida + lidos, MAX_SAIDA - 1 - lidos)) > 0)
+    lidos += n;
+  saida[lidos] = '\0';
+  close(canal[0]);
+  waitpid(pid, &estado, 0);
+  GET_TIME(fim);
+
+  if (!WIFEXITED(estado) || WEXITSTATUS(estado) != 0)
+    return -1;
+  return fim - inicio;
+}
+
+// Extrai da saída do contPrimos (ou do contPrimosSeq) o total e o espalhamento das contagens por thread
+int interpreta(const char* saida, t_execucao* exec){
+  const char* linha;
+  long long int n, soma = 0;
+  int idx, nThreads = 0;
+
+  // "Total de primos até N: X" (contPrimos) ou "Contagem de primos até N: X" (contPrimosSeq)
+  if (!(linha = strstr(saida, " de primos até ")) || sscanf(strchr(linha, ':') + 1, "%lld", &exec->total) != 1)
+    return -1;
+
+  // "Thread i) X", uma linha por consumidora
+  for (linha = strstr(saida, "Thread "); linha; linha = strstr(linha + 1, "Thread ")){
+    if (sscanf(linha, "Thread %d) %lld", &idx, &n) != 2)
+      continue;
+    if (!nThreads || n < exec->minThread)
+      exec->minThread = n;
+    if (!nThreads || n > exec->maxThread)
+      exec->maxThread = n;
+    soma += n;
+    nThreads++;
+  }
+  exec->mediaThread = nThreads ? (double)soma / nThreads : 0;
+  if (!nThreads)
+    exec->minThread = exec->maxThread = 0;
+
+  return 0;
+}
+
+// Comparação de execuções pelo tempo (para a mediana)
+int comparaTempo(const void* a, const void* b){
+  double x = ((const t_execucao*)a)->tempo, y = ((const t_execucao*)b)->tempo;
+  return (x > y) - (x < y);
+}
+
+// Executa `reps` vezes e ordena as execuções pelo tempo; devolve 1 se todas informaram a contagem `*referencia`
+// (ou a primeira define a referência, se ela for negativa), 0 se alguma divergiu e -1 se alguma falhou
+int repete(char** args, int reps, t_execucao* execs, long long int* referencia, char* saida){
+  int confere = 1;
+
+  for (int r = 0; r < reps; r++){
+    if ((execs[r].tempo = executa(args, saida)) < 0 || interpreta(saida, &execs[r])){
+      fprintf(stderr, "ERRO: Execução de %s falhou:\n%s", args[0], saida);
+      return -1;
+    }
+    if (*referencia < 0)
+      *referencia = execs[r].total;
+    else if (execs[r].total != *referencia){
+      fprintf(stderr, "ERRO: %s informou %lld primos, mas a referência é %lld!\n", args[0], execs[r].total, *referencia);
+      confere = 0;
+    }
+  }
+
+  qsort(execs, reps, sizeof(t_execucao), comparaTempo);
+  return confere;
+}
+
+int main(int argc, char* argv[]){
+  long long int listaN[MAX_LISTA], listaM[MAX_LISTA], listaCons[MAX_LISTA];
+  int nN = 0, nM = 1, nCons = 1;
+  int reps = 5;
+  const char* dir = ".";
+  char* opcoesSeq = NULL; // Modo do contPrimosSeq (padrão divisao)
+  char* opcoesPar = NULL; // Opções extras do contPrimos
+  FILE* csv = stdout;
+  int divergiu = 0;
+  int opt;
+
+  listaM[0] = 1024;
+  listaCons[0] = 1;
+
+  while ((opt = getopt(argc, argv, "N:M:t:r:d:q:x:o:")) != -1){
+    int n = 0;
+    switch (opt){
+      case 'N': n = nN = leLista(optarg, listaN); break;
+      case 'M': n = nM = leLista(optarg, listaM); break;
+      case 't': n = nCons = leLista(optarg, listaCons); break;
+      case 'r': n = reps = atoi(optarg); break;
+      case 'd': dir = optarg; n = 1; break;
+      case 'q': opcoesSeq = optarg; n = 1; break;
+      case 'x': opcoesPar = optarg; n = 1; break;
+      case 'o':
+        if (!(csv = fopen(optarg, "w"))){
+          printf("ERRO: Impossível abrir %s!\n", optarg);
+          exit(EXIT_FAILURE);
+        }
+        n = 1;
+        break;
+      default:
+        exit(EXIT_FAILURE);
+    }
+    if (n <= 0){
+      printf("ERRO: Valor inválido para -%c!\n", opt);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  if (nN == 0){
+    printf("ERRO: Há argumento faltante!\n"
+           "Tente %s -N <lista de N> (OPÇÕES), com listas separadas por vírgula (ex.: -N 1000000,10000000)\n"
+           "  -M <lista de tamanhos de buffer M, padrão 1024>\n"
+           "  -t <lista de nº de consumidoras, padrão 1>\n"
+           "  -r <repetições de cada configuração, padrão 5>\n"
+           "  -d <diretório dos binários contPrimos e contPrimosSeq, padrão .>\n"
+           "  -q <modo do contPrimosSeq (a referência), padrão divisao>\n"
+           "  -x \"<opções extras do contPrimos>\" (ex.: \"-m cursor -p roda\")\n"
+           "  -o <arquivo CSV de saída, padrão a saída padrão>\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+
+  char binSeq[4096], binPar[4096], textoN[32], textoM[32], textoCons[32];
+  char* saida = (char*)malloc(MAX_SAIDA);
+  t_execucao* execs = (t_execucao*)malloc(reps * sizeof(t_execucao));
+  if (!saida || !execs){
+    printf("ERRO: Impossível alocar memória para as execuções!\n");
+    exit(EXIT_FAILURE);
+  }
+  snprintf(binSeq, sizeof(binSeq), "%s/contPrimosSeq", dir);
+  snprintf(binPar, sizeof(binPar), "%s/contPrimos", dir);
+
+  fprintf(csv, "N,M,nCons,repeticoes,total,confere,t_seq_mediana,t_mediana,t_min,t_max,speedup,eficiencia,desbalanco\n");
+
+  for (int i = 0; i < nN; i++){
+    char* args[MAX_ARGS];
+    char copia[1024];
+    int nArgs = 0, confere;
+    long long int referencia = -1;
+    double tSeq;
+
+    // Referência sequencial: define a contagem esperada e o tempo base do speedup
+    snprintf(textoN, sizeof(textoN), "%lld", listaN[i]);
+    args[nArgs++] = binSeq;
+    args[nArgs++] = textoN;
+    if (opcoesSeq)
+      args[nArgs++] = opcoesSeq;
+    args[nArgs] = NULL;
+    if (repete(args, reps, execs, &referencia, saida) < 0)
+      exit(EXIT_FAILURE);
+    tSeq = execs[reps / 2].tempo;
+
+    for (int j = 0; j < nM; j++)
+      for (int k = 0; k < nCons; k++){
+        const t_execucao* mediana;
+        double speedup;
+
+        nArgs = 0;
+        args[nArgs++] = binPar;
+        if (opcoesPar){
+          snprintf(copia, sizeof(copia), "%s", opcoesPar); // strtok altera o texto
+          acrescentaPalavras(args, &nArgs, copia);
+        }
+        snprintf(textoM, sizeof(textoM), "%lld", listaM[j]);
+        snprintf(textoCons, sizeof(textoCons), "%lld", listaCons[k]);
+        args[nArgs++] = textoM;
+        args[nArgs++] = textoN;
+        args[nArgs++] = textoCons;
+        args[nArgs] = NULL;
+
+        if ((confere = repete(args, reps, execs, &referencia, saida)) < 0)
+          exit(EXIT_FAILURE);
+        divergiu |= !confere;
+
+        // Desbalanceamento: espalhamento das contagens por thread da execução mediana, relativo à média
+        mediana = &execs[reps / 2];
+        speedup = tSeq / mediana->tempo;
+        fprintf(csv, "%lld,%lld,%lld,%d,%lld,%d,%lf,%lf,%lf,%lf,%lf,%lf,%lf\n",
+                listaN[i], listaM[j], listaCons[k], reps, mediana->total, confere,
+                tSeq, mediana->tempo, execs[0].tempo, execs[reps - 1].tempo,
+                speedup, speedup / listaCons[k],
+                mediana->mediaThread > 0 ? (mediana->maxThread - mediana->minThread) / mediana->mediaThread : 0);
+        fflush(csv);
+      }
+  }
+
+  if (csv != stdout)
+    fclose(csv);
+  free(saida);
+  free(execs);
+
+  if (divergiu){
+    printf("ERRO: Alguma configuração informou uma contagem diferente da referência!\n");
+    exit(EXIT_FAILURE);
+  }
+  return 0;
+}
\ No newline at end of file
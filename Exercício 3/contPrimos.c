@@ -2,42 +2,137 @@
 #include <stdlib.h>
 #include <pthread.h>
 #include <semaphore.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <time.h>
+#include <stdatomic.h>
+#include "affinity.h"
+#include "spinLock.h"
+#include "mpmcQueue.h"
+#include "pipeline.h"
+#include "crivo.h"
+#include "millerRabin.h"
+#include "roda.h"
+#include "checkpoint.h"
+#include "timer.h"
+#include "lockProf.h" // Com -DLOCKPROF, perfila as esperas nos semáforos (por linha e por thread)
 
 int M;
 long long int N;
 int nCons;
+int C = 1; // Tamanho do bloco de inteiros consecutivos que um consumidor pega por acesso ao buffer
 long long int* buffer;
+int preenchidos; // Quantidade de posições preenchidas na leva atual do buffer
 
 sem_t mutex;
 sem_t bufferCheio;
 sem_t bufferVazio;
 
+t_spinlock trava; // Alternativa ao semáforo `mutex`: espera ocupada e depois futex
+int tipoTrava = -1; // Tipo da trava (`SPIN_ADAPTIVE` ou `SPIN_TICKET`), -1 para usar o semáforo `mutex`
+
+// Bloco de `qtde` candidatos consecutivos a partir de `inicio`, que passa pela fila sem lock
+typedef struct {
+  long long int inicio;
+  int qtde;
+} t_bloco;
+
+t_mpmc_queue* fila; // Fila sem lock (modo `fila`): o produtor reinsere assim que há posição livre
+
+atomic_llong cursor = 1; // Próximo inteiro ainda não reservado (modo `cursor`, sem produtora)
+
+// Checkpoint (modo `cursor`): [1, N] vira trechos fixos, e as contagens dos terminados vão periodicamente para um arquivo
+#define INTERVALO_CHECKPOINT 10 // Segundos entre gravações do checkpoint
+const char* arqCheckpoint = NULL; // Arquivo do checkpoint (NULL se desativado)
+long long int tamTrecho; // Inteiros em cada trecho
+int nTrechos;
+atomic_llong contTrechos[CHECKPOINT_MAX_TRECHOS]; // Contagem de cada trecho (CHECKPOINT_PENDENTE até terminar)
+int pendentes[CHECKPOINT_MAX_TRECHOS]; // Trechos a processar nesta execução
+int nPendentes;
+atomic_int proxPendente = 0; // Próxima posição de `pendentes` ainda não reservada
+sem_t fimCheckpoint; // Sinaliza à thread de checkpoint que as consumidoras terminaram
+
+// Modo `pipeline`: gera faixas → pré-filtra candidatos → testa → agrega, cada estágio com suas threads
+#define FAIXA_GERACAO 4096 // Inteiros de cada faixa emitida pelo estágio gerador
+
+// Faixa [inicio, fim] de inteiros, emitida pelo estágio gerador
+typedef struct {
+  long long int inicio;
+  long long int fim;
+} t_faixa;
+
+int threadsGera = 1; // Threads do estágio gerador
+int threadsFiltro = 1; // Threads do estágio de pré-filtro (as de teste são as nCons consumidoras)
+atomic_llong cursorGera = 1; // Próximo inteiro ainda não emitido pelo estágio gerador
+long long int totAgregado = 0; // Primos contados pelo estágio agregador
+long long int maiorPrimo = 0; // Maior primo visto pelo estágio agregador
+
+// Contagem de uma thread do estágio de teste, numa linha de cache só dela (as vizinhas incrementam as suas ao mesmo tempo)
+typedef struct {
+  _Alignas(64) long long int n;
+} t_contagem;
+
+// Modos de distribuição dos inteiros entre as consumidoras
+typedef enum { MODO_SEMAFORO, MODO_FILA, MODO_CURSOR, MODO_CRIVO, MODO_PIPELINE, NMODOS } t_modo;
+const char* nomesModos[NMODOS] = {"semaforo", "fila", "cursor", "crivo", "pipeline"};
+
+t_affinity afinidade; // Política de fixação das threads nas CPUs (produtora = 0, consumidoras = 1..nCons)
+
+// Entra na zona crítica dos consumidores, com a trava escolhida
+void entraZona(){
+  if (tipoTrava < 0)
+    profSemLock(&mutex);
+  else
+    spinLock(&trava);
+}
+
+// Sai da zona crítica dos consumidores
+void saiZona(){
+  if (tipoTrava < 0)
+    profSemUnlock(&mutex);
+  else
+    spinUnlock(&trava);
+}
+
 // Função verificadora de primos
 int ehPrimo(long long int n) {
   if (n <= 1) return 0;
   if (n == 2) return 1;
   if (n%2 == 0) return 0;
-  for (int i = 3; i*i <= n; i += 2)
+  for (long long int i = 3; i <= n / i; i += 2) // `i <= n/i` não estoura, ao contrário de `i*i <= n`
     if (n%i == 0) return 0;
   return 1;
 }
 
+int (*testaPrimo)(long long int) = ehPrimo; // Teste de primalidade usado pelas consumidoras
+
+// Sucessor de um inteiro (sem roda, todo inteiro é candidato)
+long long int sucessor(long long int n){
+  return n + 1;
+}
+
+long long int (*proximo)(long long int) = sucessor; // Próximo candidato a primo (com roda, pula múltiplos de 2, 3, 5 e 7)
+long long int ultimo; // Último candidato até N
+
 // Corpo do programa da thread produtora
 void* threadProd(void* args){
-  long long int currN = 1; // Inteiro atual a ser adicionado no buffer
+  long long int currN = proximo(0); // Candidato atual a ser adicionado no buffer
   
   // Preenchimento é feito enquanto número atual não ultrapassa o limiar
   while (currN <= N) {
     // Aguarda o buffer ficar vazio
-    sem_wait(&bufferVazio);
+    profSemWait(&bufferVazio);
 
-    // Povoa o buffer com os inteiros
-    for (int i = 0; i < M && currN <= N; i++)
-      buffer[i] = currN++;
+    // Povoa o buffer com os candidatos
+    for (preenchidos = 0; preenchidos < M && currN <= N; preenchidos++){
+      buffer[preenchidos] = currN;
+      currN = proximo(currN);
+    }
 
-    // Libera as threads consumidoras
-    for (int i = 0; i < M; i++)
-      sem_post(&bufferCheio);
+    // Libera as threads consumidoras (um sinal por bloco de até C inteiros)
+    for (int i = 0; i < preenchidos; i += C)
+      profSemPost(&bufferCheio);
   }
 
   pthread_exit(NULL);
@@ -47,66 +142,408 @@ void* threadProd(void* args){
 void* threadCons(void* args){
   static int idxBuffer = 0; // Índice atual (global) do próximo inteiro a ser lido no buffer
   static int acabou = 0; // Flag indicando se a produção já acabou
-  long long int numColetado; // Cópia local do número lido no buffer
+  long long int* bloco; // Cópia local do bloco lido no buffer
+  int qtde; // Quantidade de inteiros no bloco
   long long int contPrimos = 0; // Contagem de primos da thread
   long long int* ret;
 
   ret = (long long int*)malloc(sizeof(long long int));
-  if (!ret){
+  bloco = (long long int*)malloc(C * sizeof(long long int));
+  if (!ret || !bloco){
     printf("\nERRO: Impossível alocar variável auxiliar de retorno da thread!\n");
+    free(ret);
+    free(bloco);
     pthread_exit(NULL);
   }
 
   while (1){
-    // Espera o buffer ficar cheio
-    sem_wait(&bufferCheio);
+    // Espera haver um bloco disponível no buffer
+    profSemWait(&bufferCheio);
     
     // Sai do loop caso já tenha acabado de produzir
     if (acabou)
       break;
 
     // Zona crítica (acesso a `idxBuffer`)
-    sem_wait(&mutex);
-    numColetado = buffer[idxBuffer]; // Lê o próximo inteiro
-    idxBuffer++;
+    entraZona();
+    qtde = preenchidos - idxBuffer < C ? preenchidos - idxBuffer : C;
+    for (int i = 0; i < qtde; i++)
+      bloco[i] = buffer[idxBuffer + i]; // Lê os próximos inteiros
+    idxBuffer += qtde;
 
-    if (numColetado == N){ // Se o número lido é o último...
+    if (bloco[qtde - 1] == ultimo){ // Se o último número lido é o último...
       acabou = 1; // não há mais números para testar...
       for (int i = 0; i < nCons; i++)
-        sem_post(&bufferCheio); // libero todas as threads consumidoras
+        profSemPost(&bufferCheio); // libero todas as threads consumidoras
     }
 
-    if (idxBuffer == M){ // Se todos os elementos do buffer já foram lidos...
-      sem_post(&bufferVazio); // libera thread produtora...
+    if (idxBuffer == preenchidos){ // Se todos os elementos do buffer já foram lidos...
+      profSemPost(&bufferVazio); // libera thread produtora...
       idxBuffer = 0; // e reseta o índice do buffer para 0
     }
-    sem_post(&mutex);
+    saiZona();
 
-    // Faz operação custosa (verificar se é primo)
-    if (ehPrimo(numColetado))
-      contPrimos++;
+    // Faz operação custosa (verificar se é primo) fora da zona crítica
+    for (int i = 0; i < qtde; i++)
+      if (testaPrimo(bloco[i]))
+        contPrimos++;
   }
 
+  free(bloco);
   *ret = contPrimos;
   pthread_exit((void*)ret);
 }
 
+// Corpo do programa da thread produtora no modo `fila`
+void* threadProdFila(void* args){
+  t_bloco bloco;
+
+  long long int n = proximo(0);
+
+  // Insere blocos de até C candidatos assim que houver posição livre na fila
+  while (n <= N){
+    bloco.inicio = n;
+    for (bloco.qtde = 0; bloco.qtde < C && n <= N; bloco.qtde++)
+      n = proximo(n);
+    mpmcPush(fila, &bloco);
+  }
+
+  // Fim do fluxo: os consumidores esvaziam a fila e terminam
+  mpmcClose(fila);
+  pthread_exit(NULL);
+}
+
+// Corpo do programa da thread consumidora no modo `fila`
+void* threadConsFila(void* args){
+  t_bloco bloco;
+  long long int contPrimos = 0; // Contagem de primos da thread
+  long long int* ret;
+
+  ret = (long long int*)malloc(sizeof(long long int));
+  if (!ret){
+    printf("\nERRO: Impossível alocar variável auxiliar de retorno da thread!\n");
+    pthread_exit(NULL);
+  }
+
+  while (mpmcPop(fila, &bloco)){
+    long long int n = bloco.inicio;
+    for (int i = 0; i < bloco.qtde; i++, n = proximo(n))
+      if (testaPrimo(n))
+        contPrimos++;
+  }
+
+  *ret = contPrimos;
+  pthread_exit((void*)ret);
+}
+
+// Corpo do programa da thread consumidora no modo `cursor` (sem produtora)
+void* threadConsCursor(void* args){
+  long long int inicio, qtde; // Faixa reservada [inicio, inicio + qtde)
+  long long int contPrimos = 0; // Contagem de primos da thread
+  long long int* ret;
+
+  ret = (long long int*)malloc(sizeof(long long int));
+  if (!ret){
+    printf("\nERRO: Impossível alocar variável auxiliar de retorno da thread!\n");
+    pthread_exit(NULL);
+  }
+
+  inicio = atomic_load_explicit(&cursor, memory_order_relaxed);
+  while (inicio <= N){
+    // Faixa guiada: uma fração do que resta, que encolhe perto do fim (no mínimo C), já que
+    // `ehPrimo` fica mais caro com n e as últimas faixas precisam ser pequenas para equilibrar
+    qtde = (N - inicio + 1) / (2 * nCons);
+    if (qtde < C)
+      qtde = C;
+
+    // Reserva [inicio, inicio + qtde); se outra thread chegou antes, `inicio` recebe o novo cursor
+    if (!atomic_compare_exchange_weak_explicit(&cursor, &inicio, inicio + qtde, memory_order_relaxed, memory_order_relaxed))
+      continue;
+
+    for (long long int n = proximo(inicio - 1); n < inicio + qtde && n <= N; n = proximo(n))
+      if (testaPrimo(n))
+        contPrimos++;
+
+    inicio = atomic_load_explicit(&cursor, memory_order_relaxed);
+  }
+
+  *ret = contPrimos;
+  pthread_exit((void*)ret);
+}
+
+// Estágio gerador (modo `pipeline`): reserva faixas de inteiros consecutivos e as emite
+void estagioGera(t_pipe_ctx* ctx, const void* elem, void* arg){
+  t_faixa faixa;
+
+  while ((faixa.inicio = atomic_fetch_add_explicit(&cursorGera, FAIXA_GERACAO, memory_order_relaxed)) <= N){
+    faixa.fim = faixa.inicio + FAIXA_GERACAO - 1 < N ? faixa.inicio + FAIXA_GERACAO - 1 : N;
+    pipeEmit(ctx, &faixa);
+  }
+}
+
+// Estágio de pré-filtro (modo `pipeline`): só passam adiante 2, 3, 5, 7 e os candidatos coprimos com 210
+void estagioFiltra(t_pipe_ctx* ctx, const void* elem, void* arg){
+  const t_faixa* faixa = (const t_faixa*)elem;
+
+  for (long long int n = proximo(faixa->inicio - 1); n <= faixa->fim; n = proximo(n))
+    if (n < 11 ? n == 2 || n == 3 || n == 5 || n == 7 : n % 2 && n % 3 && n % 5 && n % 7)
+      pipeEmit(ctx, &n);
+}
+
+// Estágio de teste (modo `pipeline`): conta os primos por thread (em `arg`, um `t_contagem` por thread) e os emite ao agregador
+void estagioTesta(t_pipe_ctx* ctx, const void* elem, void* arg){
+  long long int n = *(const long long int*)elem;
+
+  if (testaPrimo(n)){
+    ((t_contagem*)arg)[pipeWorker(ctx)].n++;
+    pipeEmit(ctx, &n);
+  }
+}
+
+// Estágio agregador (modo `pipeline`, uma thread): total e maior primo
+void estagioAgrega(t_pipe_ctx* ctx, const void* elem, void* arg){
+  long long int n = *(const long long int*)elem;
+
+  totAgregado++;
+  if (n > maiorPrimo)
+    maiorPrimo = n;
+}
+
+// Corpo do programa da thread consumidora no modo `cursor` com checkpoint: reserva trechos inteiros ainda pendentes
+void* threadConsTrechos(void* args){
+  int i; // Posição reservada em `pendentes`
+  long long int contPrimos = 0; // Contagem de primos da thread
+  long long int* ret;
+
+  ret = (long long int*)malloc(sizeof(long long int));
+  if (!ret){
+    printf("\nERRO: Impossível alocar variável auxiliar de retorno da thread!\n");
+    pthread_exit(NULL);
+  }
+
+  while ((i = atomic_fetch_add_explicit(&proxPendente, 1, memory_order_relaxed)) < nPendentes){
+    int t = pendentes[i];
+    long long int inicio = t * tamTrecho + 1;
+    long long int fimTrecho = inicio + tamTrecho - 1 < N ? inicio + tamTrecho - 1 : N;
+    long long int contTrecho = 0;
+
+    for (long long int n = proximo(inicio - 1); n <= fimTrecho; n = proximo(n))
+      if (testaPrimo(n))
+        contTrecho++;
+
+    // Único custo do checkpoint no caminho quente: publicar a contagem do trecho
+    atomic_store_explicit(&contTrechos[t], contTrecho, memory_order_release);
+    contPrimos += contTrecho;
+  }
+
+  *ret = contPrimos;
+  pthread_exit((void*)ret);
+}
+
+// Grava o estado atual dos trechos no arquivo de checkpoint
+void gravaCheckpoint(){
+  long long int copia[CHECKPOINT_MAX_TRECHOS];
+
+  for (int t = 0; t < nTrechos; t++)
+    copia[t] = atomic_load_explicit(&contTrechos[t], memory_order_acquire);
+
+  if (checkpointGrava(arqCheckpoint, N, tamTrecho, nTrechos, copia))
+    printf("ERRO: Impossível gravar o checkpoint em %s (a contagem continua)!\n", arqCheckpoint);
+}
+
+// Corpo do programa da thread de checkpoint: grava periodicamente, fora do caminho das consumidoras, e uma última vez no fim
+void* threadCheckpoint(void* args){
+  struct timespec prazo;
+  int acabou = 0;
+
+  while (!acabou){
+    clock_gettime(CLOCK_REALTIME, &prazo);
+    prazo.tv_sec += INTERVALO_CHECKPOINT;
+    acabou = sem_timedwait(&fimCheckpoint, &prazo) == 0;
+    gravaCheckpoint();
+  }
+
+  pthread_exit(NULL);
+}
+
 int main(int argc, char* argv[]){
 	long long int* contPrimos;
   long long int totPrimos = 0; // Contagem total de primos
 	long long int maxContPrimos = 0; // Contagem de primos máxima dentre os consumidores
   int threadVencedora; // Índice da thread vencedora
+  pthread_attr_t attr, *attrPtr; // Atributos das threads (fixação em CPU)
+  const char* politica = "none"; // Política de afinidade
+  t_modo modo = MODO_SEMAFORO; // Modo de distribuição dos inteiros
+  void* (*corpoProd)(void*) = threadProd;
+  void* (*corpoCons)(void*) = threadCons;
+  double inicio, fim; // Instantes de início e fim da contagem
+  int retomar = 0; // Retomar do checkpoint (--resume)
+  long long int totRetomado = 0; // Primos dos trechos já terminados numa execução anterior
+  pthread_t tidCheckpoint;
+  int opt;
+  static const struct option opcoesLongas[] = {
+    {"resume", no_argument, NULL, 'r'},
+    {"checkpoint", required_argument, NULL, 'k'},
+    {NULL, 0, NULL, 0}
+  };
+
+  // Opções (antes ou depois dos argumentos obrigatórios)
+  while ((opt = getopt_long(argc, argv, "a:t:c:m:p:k:rs:", opcoesLongas, NULL)) != -1){
+    switch (opt){
+      case 's': // Threads dos estágios gerador e de pré-filtro (modo `pipeline`)
+        if (sscanf(optarg, "%d,%d", &threadsGera, &threadsFiltro) != 2 || threadsGera < 1 || threadsFiltro < 1){
+          printf("ERRO: Threads de estágio inválidas!\n");
+          exit(EXIT_FAILURE);
+        }
+        break;
+      case 'k': // Arquivo de checkpoint
+        arqCheckpoint = optarg;
+        break;
+      case 'r': // Retoma do checkpoint, pulando os trechos já terminados
+        retomar = 1;
+        break;
+      case 'a': // Política de afinidade
+        politica = optarg;
+        break;
+      case 't': // Trava da zona crítica dos consumidores: semáforo (padrão), spin adaptativo ou ticket
+        if (!strcmp(optarg, "spin"))
+          tipoTrava = SPIN_ADAPTIVE;
+        else if (!strcmp(optarg, "ticket"))
+          tipoTrava = SPIN_TICKET;
+        else if (strcmp(optarg, "sem")){
+          printf("ERRO: Trava inválida!\n");
+          exit(EXIT_FAILURE);
+        }
+        break;
+      case 'c': // Bloco de consumo: inteiros consecutivos pegos por um consumidor a cada acesso
+        if ((C = atoi(optarg)) <= 0){
+          printf("ERRO: Bloco de consumo inválido!\n");
+          exit(EXIT_FAILURE);
+        }
+        break;
+      case 'm': // Modo de distribuição dos inteiros entre as consumidoras
+        for (modo = 0; modo < NMODOS && strcmp(optarg, nomesModos[modo]); modo++);
+        if (modo == NMODOS){
+          printf("ERRO: Modo inválido!\n");
+          exit(EXIT_FAILURE);
+        }
+        break;
+      case 'p': // Teste de primalidade: divisão por tentativa (padrão), com roda e tabela de primos ou Miller–Rabin
+        if (!strcmp(optarg, "mr"))
+          testaPrimo = ehPrimoMR;
+        else if (!strcmp(optarg, "roda")){
+          testaPrimo = ehPrimoRoda;
+          proximo = rodaProximo; // A produtora nem emite os múltiplos de 2, 3, 5 e 7
+        }
+        else if (strcmp(optarg, "divisao")){
+          printf("ERRO: Teste de primalidade inválido!\n");
+          exit(EXIT_FAILURE);
+        }
+        break;
+      default:
+        exit(EXIT_FAILURE);
+    }
+  }
 	
-	if (argc < 4){
+	if (argc - optind < 3){
 	  printf("ERRO: Há argumentos faltantes na chamada do programa!\n"
-           "Tente %s <tamanho do buffer M> <nº de inteiros N> <nº de threads consumidoras>\n", 
-           argv[0]);
+           "Tente %s <tamanho do buffer M> <nº de inteiros N> <nº de threads consumidoras> (OPÇÕES)\n"
+           "  -a <afinidade: none|compact|scatter|physical|lista de CPUs>\n"
+           "  -t <trava: sem|spin|ticket> (modo semaforo)\n"
+           "  -c <bloco de consumo C, padrão 1 (no modo cursor, tamanho mínimo das faixas)>\n"
+           "  -p <teste de primalidade: divisao (padrão)|roda (roda 2·3·5·7, só candidatos coprimos com 210)|\n"
+           "                            mr (Miller–Rabin determinístico)>\n"
+           "  -m <modo: semaforo (buffer preenchido por levas, padrão)|fila (fila sem lock, reabastecida continuamente)|\n"
+           "           cursor (sem produtora: consumidoras reservam faixas guiadas de um cursor atômico)|\n"
+           "           crivo (crivo de Eratóstenes segmentado, com as consumidoras crivando segmentos)|\n"
+           "           pipeline (gera → pré-filtra → testa (as consumidoras) → agrega, com lotes de C e filas de M/C lotes)>\n"
+           "  -s <G,F: threads dos estágios gerador e de pré-filtro do modo pipeline, padrão 1,1>\n"
+           "  -k, --checkpoint <arquivo> (modo cursor: grava a cada %d s as contagens dos trechos terminados)\n"
+           "  -r, --resume (retoma do checkpoint, pulando os trechos terminados)\n",
+           argv[0], INTERVALO_CHECKPOINT);
 	  exit(EXIT_FAILURE);
 	}
 	
-	M = atoi(argv[1]); // Tamanho do buffer
-	N = atoll(argv[2]); // Limite superior do intervalo
-	nCons = atoi(argv[3]); // Número de threads consumidoras
+	M = atoi(argv[optind]); // Tamanho do buffer
+	N = atoll(argv[optind + 1]); // Limite superior do intervalo
+  ultimo = proximo == rodaProximo ? rodaAnterior(N) : N;
+	nCons = atoi(argv[optind + 2]); // Número de threads consumidoras
+
+  // Também evita as divisões por zero nas capacidades M/C das filas
+  if (M < 1 || nCons < 1){
+    printf("ERRO: O tamanho do buffer e o nº de threads consumidoras devem ser positivos!\n");
+    exit(EXIT_FAILURE);
+  }
+
+  if (affinityParse(politica, &afinidade)){
+    printf("ERRO: Política de afinidade inválida!\n");
+    exit(EXIT_FAILURE);
+  }
+
+  if (tipoTrava >= 0)
+    spinInit(&trava, tipoTrava);
+
+  // O bloco de consumo não passa do tamanho do buffer (que não existe no modo `cursor`)
+  if (C > M && modo != MODO_CURSOR)
+    C = M;
+
+  // Nos modos `cursor`, `crivo` e `pipeline`, não há produtora: as consumidoras ocupam as posições de afinidade a partir de 0
+  if (modo == MODO_CURSOR || modo == MODO_CRIVO || modo == MODO_PIPELINE){
+    corpoProd = NULL;
+    corpoCons = threadConsCursor;
+  }
+
+  // Com checkpoint, as faixas guiadas dão lugar a trechos fixos (no mínimo C inteiros), que são o que se grava
+  if (retomar && !arqCheckpoint){
+    printf("ERRO: --resume precisa do arquivo de checkpoint (-k)!\n");
+    exit(EXIT_FAILURE);
+  }
+  if (arqCheckpoint){
+    long long int lidas[CHECKPOINT_MAX_TRECHOS];
+
+    if (modo != MODO_CURSOR){
+      printf("ERRO: Checkpoint só é suportado no modo cursor!\n");
+      exit(EXIT_FAILURE);
+    }
+
+    if (retomar){
+      if (checkpointLe(arqCheckpoint, N, &tamTrecho, &nTrechos, lidas)){
+        printf("ERRO: Impossível retomar do checkpoint em %s (ausente, corrompido ou de outro N)!\n", arqCheckpoint);
+        exit(EXIT_FAILURE);
+      }
+    }
+    else {
+      tamTrecho = (N + CHECKPOINT_MAX_TRECHOS - 1) / CHECKPOINT_MAX_TRECHOS;
+      if (tamTrecho < C)
+        tamTrecho = C;
+      nTrechos = N > 0 ? (int)((N + tamTrecho - 1) / tamTrecho) : 0;
+      for (int t = 0; t < nTrechos; t++)
+        lidas[t] = CHECKPOINT_PENDENTE;
+    }
+
+    nPendentes = 0;
+    for (int t = 0; t < nTrechos; t++){
+      atomic_init(&contTrechos[t], lidas[t]);
+      if (lidas[t] == CHECKPOINT_PENDENTE)
+        pendentes[nPendentes++] = t;
+      else
+        totRetomado += lidas[t];
+    }
+
+    sem_init(&fimCheckpoint, 0, 0);
+    corpoCons = threadConsTrechos;
+  }
+
+  // No modo `fila`, o buffer de M inteiros vira uma fila de M/C blocos de C inteiros
+  if (modo == MODO_FILA){
+    fila = mpmcCreate(M / C, sizeof(t_bloco));
+    if (!fila){
+      printf("ERRO: Impossível alocar memória para a fila!\n");
+      exit(EXIT_FAILURE);
+    }
+    corpoProd = threadProdFila;
+    corpoCons = threadConsFila;
+  }
 	
 	buffer = (long long int*)calloc(M, sizeof(long long int));
 	if (!buffer){
@@ -121,29 +558,77 @@ int main(int argc, char* argv[]){
 	pthread_t tidProd;
 	pthread_t tidsCons[nCons];
   long long int contagens[nCons];
+  t_contagem* contTesta = NULL;
+  t_pipeline* pl = NULL;
+
+  // No modo `pipeline`, os lotes têm C elementos e as filas entre os estágios, M/C lotes (como no modo `fila`)
+  if (modo == MODO_PIPELINE){
+    contTesta = (t_contagem*)aligned_alloc(_Alignof(t_contagem), nCons * sizeof(t_contagem));
+    if (contTesta)
+      memset(contTesta, 0, nCons * sizeof(t_contagem));
+    if (!contTesta
+        || !(pl = pipeCreate(&afinidade))
+        || pipeAddStage(pl, "gera", estagioGera, NULL, sizeof(t_faixa), threadsGera, 1, M / C)
+        || pipeAddStage(pl, "pre-filtro", estagioFiltra, NULL, sizeof(long long int), threadsFiltro, C, M / C)
+        || pipeAddStage(pl, "testa", estagioTesta, contTesta, sizeof(long long int), nCons, C, M / C)
+        || pipeAddStage(pl, "agrega", estagioAgrega, NULL, 0, 1, 1, 0)){
+      printf("ERRO: Impossível alocar memória para o pipeline!\n");
+      exit(EXIT_FAILURE);
+    }
+  }
 	
+  GET_TIME(inicio);
+
+  // No modo `crivo`, as consumidoras são as threads do crivo segmentado
+  if (modo == MODO_CRIVO && crivoConta(N, nCons, contagens, &afinidade) < 0){
+    printf("ERRO: Impossível alocar memória para o crivo!\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // No modo `pipeline`, as consumidoras são as threads do estágio de teste
+  if (modo == MODO_PIPELINE && pipeRun(pl)){
+    printf("ERRO: Impossível executar o pipeline!\n");
+    exit(EXIT_FAILURE);
+  }
+  for (int i = 0; i < nCons && contTesta; i++)
+    contagens[i] = contTesta[i].n;
+
+  // Criando thread de checkpoint (sem afinidade: passa quase todo o tempo dormindo)
+  if (arqCheckpoint && pthread_create(&tidCheckpoint, NULL, threadCheckpoint, NULL)){
+    printf("ERRO: Impossível criar thread de checkpoint!\n");
+    exit(EXIT_FAILURE);
+  }
+
   // Criando thread produtora
-	if (pthread_create(&tidProd, NULL, threadProd, NULL)){
-	  printf("ERRO: Impossível criar thread produtora!\n");
-	  exit(EXIT_FAILURE);
-	}
+  if (corpoProd){
+    attrPtr = affinityAttr(&afinidade, 0, &attr);
+    if (pthread_create(&tidProd, attrPtr, corpoProd, NULL)){
+      printf("ERRO: Impossível criar thread produtora!\n");
+      exit(EXIT_FAILURE);
+    }
+    if (attrPtr)
+      pthread_attr_destroy(attrPtr);
+  }
 	
   // Criando threads consumidoras
-	for (int i = 0; i < nCons; i++){
-	  if (pthread_create(&tidsCons[i], NULL, threadCons, NULL)){
+	for (int i = 0; i < nCons && modo != MODO_CRIVO && modo != MODO_PIPELINE; i++){
+    attrPtr = affinityAttr(&afinidade, corpoProd ? i + 1 : i, &attr);
+	  if (pthread_create(&tidsCons[i], attrPtr, corpoCons, NULL)){
 	    printf("ERRO: Impossível criar thread consumidora!\n");
 	    exit(EXIT_FAILURE);
 	  }
+    if (attrPtr)
+      pthread_attr_destroy(attrPtr);
 	}
 	
   // Capturando thread produtora
-	if (pthread_join(tidProd, NULL)){
+	if (corpoProd && pthread_join(tidProd, NULL)){
 	  printf("ERRO: Impossível capturar thread produtora!\n");
 	  exit(EXIT_FAILURE);
 	}
 	
   // Capturando threads consumidoras (e assimilando seus retornos)
-	for (int i = 0; i < nCons; i++){
+	for (int i = 0; i < nCons && modo != MODO_CRIVO && modo != MODO_PIPELINE; i++){
 	  if (pthread_join(tidsCons[i], (void**)&contPrimos)){
 	    printf("ERRO: Impossível capturar thread consumidora!\n");
 	    exit(EXIT_FAILURE);
@@ -151,21 +636,41 @@ int main(int argc, char* argv[]){
     if (!contPrimos) // Acontece quando variável de retorno não pôde ser alocada
 	    exit(EXIT_FAILURE);
 
-    totPrimos += *contPrimos;
-	  if (*contPrimos > maxContPrimos){
-      threadVencedora = i;
-	    maxContPrimos = *contPrimos;
-    }
     contagens[i] = *contPrimos;
 	  free(contPrimos);
 	}
 
+  // Última gravação do checkpoint, já com todos os trechos terminados
+  if (arqCheckpoint){
+    sem_post(&fimCheckpoint);
+    pthread_join(tidCheckpoint, NULL);
+    sem_destroy(&fimCheckpoint);
+  }
+
+  GET_TIME(fim);
+
+  // Totalizando e escolhendo a thread vencedora
+  for (int i = 0; i < nCons; i++){
+    totPrimos += contagens[i];
+	  if (contagens[i] > maxContPrimos){
+      threadVencedora = i;
+	    maxContPrimos = contagens[i];
+    }
+  }
+
   free(buffer);
+  free(contTesta);
+  mpmcDestroy(fila);
   sem_destroy(&mutex);
   sem_destroy(&bufferCheio);
   sem_destroy(&bufferVazio);
 
+  totPrimos += totRetomado;
+
   printf("Total de primos até %lld: %lld\n", N, totPrimos);
+  if (retomar)
+    printf("Retomados do checkpoint: %d de %d trechos, com %lld primos\n", nTrechos - nPendentes, nTrechos, totRetomado);
+  printf("Tempo (modo %s): %lf s, %.0f inteiros/s\n", nomesModos[modo], fim - inicio, N / (fim - inicio));
 
   printf("Contagens de primos por thread:\n");
   for (int i = 0; i < nCons; i++)
@@ -173,6 +678,13 @@ int main(int argc, char* argv[]){
   
   printf("A thread vencedora foi %d, com uma contagem de %lld primos!\n", 
           threadVencedora+1, maxContPrimos);
+
+  if (pl){
+    printf("Maior primo até %lld: %lld (%lld primos agregados)\n", N, maiorPrimo, totAgregado);
+    printf("Estágios do pipeline:\n");
+    pipeReport(pl, stdout);
+    pipeDestroy(pl);
+  }
 	
 	return 0;
 }
\ No newline at end of file
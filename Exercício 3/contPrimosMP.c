@@ -0,0 +1,342 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "affinity.h"
+#include "millerRabin.h"
+#include "roda.h"
+#include "timer.h"
+
+// Contagem de primos com vários processos (em vez de threads), coordenados por um segmento de memória
+// compartilhada POSIX (shm_open) com um cursor atômico de trechos e uma tabela de resultados por processo.
+// O coordenador cria os processos trabalhadores com fork e, se um deles cai, devolve os trechos que ele tinha
+// reservado e não terminou e põe outro processo em seu lugar. Ligar com -lrt em glibc antigas.
+
+#define MAX_PROCS 256 // Máximo de processos trabalhadores
+#define TRECHOS_POR_PROC 256 // Trechos por processo (o suficiente para equilibrar a carga)
+#define MAX_REINICIOS 3 // Quantas vezes o lugar de um processo pode ser reocupado depois de quedas
+
+// Estado de um trecho (valores >= 0 indicam o processo que o está contando)
+#define TRECHO_LIVRE (-1)
+#define TRECHO_FEITO (-2)
+#define TRECHO_ORFAO (-3) // Era de um processo que caiu
+
+// Linha da tabela de resultados de um processo
+typedef struct {
+  _Alignas(64) atomic_llong contagem; // Primos nos trechos terminados pelo processo
+  atomic_int trechos; // Trechos terminados pelo processo
+  pid_t pid; // Processo que ocupa o lugar atualmente
+  int no; // Nó NUMA em que o processo foi fixado (-1 se nenhum)
+  int quedas; // Quedas de processos nesse lugar
+} t_proc;
+
+// Trecho [inicio, inicio + tamTrecho) de inteiros
+typedef struct {
+  atomic_int estado; // TRECHO_LIVRE, TRECHO_FEITO, TRECHO_ORFAO ou o processo que o reservou
+  long long int contagem; // Primos do trecho (válido quando TRECHO_FEITO)
+} t_trecho;
+
+// Segmento compartilhado (os trechos vêm logo depois da estrutura)
+typedef struct {
+  long long int N;
+  long long int tamTrecho;
+  int nTrechos;
+  atomic_int falhaSimulada; // 1 enquanto a queda simulada (-F) ainda não aconteceu
+  _Alignas(64) atomic_int cursor; // Próximo trecho ainda não reservado
+  t_proc procs[MAX_PROCS + 1]; // O último lugar é do coordenador (varredura final)
+  t_trecho trechos[];
+} t_compartilhado;
+
+t_compartilhado* shm;
+int trechoFalha = -1; // Trecho cujo processo cai de propósito (-F), -1 se nenhum
+
+// Função verificadora de primos
+int ehPrimo(long long int n) {
+  if (n <= 1) return 0;
+  if (n == 2) return 1;
+  if (n%2 == 0) return 0;
+  for (long long int i = 3; i <= n / i; i += 2) // `i <= n/i` não estoura, ao contrário de `i*i <= n`
+    if (n%i == 0) return 0;
+  return 1;
+}
+
+int (*testaPrimo)(long long int) = ehPrimo; // Teste de primalidade usado pelos processos
+
+// Sucessor de um inteiro (sem roda, todo inteiro é candidato)
+long long int sucessor(long long int n){
+  return n + 1;
+}
+
+long long int (*proximo)(long long int) = sucessor; // Próximo candidato a primo
+
+// Conta os primos do trecho `t`, já reservado pelo processo `p`, e publica o resultado
+void contaTrecho(int t, int p){
+  long long int inicio = t * shm->tamTrecho + 1;
+  long long int fim = inicio + shm->tamTrecho - 1 < shm->N ? inicio + shm->tamTrecho - 1 : shm->N;
+  long long int contagem = 0;
+
+  for (long long int n = proximo(inicio - 1); n <= fim; n = proximo(n))
+    if (testaPrimo(n))
+      contagem++;
+
+  // Queda simulada antes de publicar o resultado: o trecho fica reservado por um processo morto
+  if (t == trechoFalha && atomic_exchange(&shm->falhaSimulada, 0))
+    abort();
+
+  shm->trechos[t].contagem = contagem;
+  atomic_store_explicit(&shm->trechos[t].estado, TRECHO_FEITO, memory_order_release);
+  atomic_fetch_add_explicit(&shm->procs[p].contagem, contagem, memory_order_relaxed);
+  atomic_fetch_add_explicit(&shm->procs[p].trechos, 1, memory_order_relaxed);
+}
+
+// Tenta reservar o trecho `t` (livre ou órfão) para o processo `p`
+int reservaTrecho(int t, int p){
+  int estado = atomic_load_explicit(&shm->trechos[t].estado, memory_order_relaxed);
+
+  if (estado != TRECHO_LIVRE && estado != TRECHO_ORFAO)
+    return 0;
+  return atomic_compare_exchange_strong_explicit(&shm->trechos[t].estado, &estado, p, memory_order_acquire, memory_order_relaxed);
+}
+
+// Corpo de um processo trabalhador (ou da varredura final do coordenador)
+void trabalha(int p){
+  int t;
+
+  // Primeiro, os trechos em ordem pelo cursor...
+  while ((t = atomic_fetch_add_explicit(&shm->cursor, 1, memory_order_relaxed)) < shm->nTrechos)
+    if (reservaTrecho(t, p))
+      contaTrecho(t, p);
+
+  // ... depois, as sobras: órfãos de processos que caíram e trechos que eles pegaram do cursor sem reservar
+  for (t = 0; t < shm->nTrechos; t++)
+    if (reservaTrecho(t, p))
+      contaTrecho(t, p);
+}
+
+// Quantidade de nós NUMA do host (1 se a topologia não pôde ser lida)
+int contaNos(){
+  char caminho[128];
+  int n = 0;
+
+  do
+    snprintf(caminho, sizeof(caminho), "/sys/devices/system/node/node%d", n);
+  while (access(caminho, F_OK) == 0 && ++n);
+
+  return n > 0 ? n : 1;
+}
+
+// Fixa o processo atual nas CPUs do nó NUMA `no`; devolve 0 ou -1 se não foi possível
+int fixaNo(int no){
+  char caminho[128], lista[4096];
+  t_affinity cpusNo;
+  cpu_set_t conjunto;
+  FILE* arq;
+
+  snprintf(caminho, sizeof(caminho), "/sys/devices/system/node/node%d/cpulist", no);
+  if (!(arq = fopen(caminho, "r")))
+    return -1;
+  if (!fgets(lista, sizeof(lista), arq)){
+    fclose(arq);
+    return -1;
+  }
+  fclose(arq);
+
+  // A lista do nó tem o mesmo formato das listas de CPUs da afinidade ("0-3,8-11")
+  if (affinityParse(lista, &cpusNo))
+    return -1;
+  CPU_ZERO(&conjunto);
+  for (int i = 0; i < cpusNo.nCpus; i++)
+    CPU_SET(cpusNo.cpus[i], &conjunto);
+  return sched_setaffinity(0, sizeof(conjunto), &conjunto);
+}
+
+// Cria o processo trabalhador do lugar `p`; devolve o pid, ou -1 se o fork falhou
+pid_t criaTrabalhador(int p, int numa, int nNos, const t_affinity* afinidade){
+  pid_t pid = fork();
+
+  if (pid != 0)
+    return pid;
+
+  // Filho: fixa-se (no nó NUMA ou na CPU da política) e conta até acabarem os trechos
+  if (numa)
+    fixaNo(p % nNos);
+  else
+    affinityPinSelf(afinidade, p);
+  trabalha(p);
+  _exit(EXIT_SUCCESS);
+}
+
+int main(int argc, char* argv[]){
+  long long int N;
+  int nProcs;
+  const char* politica = "none";
+  t_affinity afinidade;
+  int numa = 0, nNos = 1;
+  int vivos, opt;
+  char nome[64];
+  size_t tamanho;
+  int fd;
+  long long int tamTrecho, totPrimos = 0;
+  double inicio, fim;
+
+  while ((opt = getopt(argc, argv, "a:p:F:")) != -1){
+    switch (opt){
+      case 'a': // Fixação dos processos: num nó NUMA cada (numa) ou numa CPU da política de afinidade
+        politica = optarg;
+        break;
+      case 'p': // Teste de primalidade: divisão por tentativa (padrão), com roda e tabela de primos ou Miller–Rabin
+        if (!strcmp(optarg, "mr"))
+          testaPrimo = ehPrimoMR;
+        else if (!strcmp(optarg, "roda")){
+          testaPrimo = ehPrimoRoda;
+          proximo = rodaProximo;
+        }
+        else if (strcmp(optarg, "divisao")){
+          printf("ERRO: Teste de primalidade inválido!\n");
+          exit(EXIT_FAILURE);
+        }
+        break;
+      case 'F': // Simula a queda do processo que pegar o trecho indicado
+        trechoFalha = atoi(optarg);
+        break;
+      default:
+        exit(EXIT_FAILURE);
+    }
+  }
+
+  if (argc - optind < 2){
+    printf("ERRO: Há argumentos faltantes na chamada do programa!\n"
+           "Tente %s <nº de inteiros N> <nº de processos> (OPÇÕES)\n"
+           "  -a <fixação: numa (um nó NUMA por processo, em rodízio)|none|compact|scatter|physical|lista de CPUs>\n"
+           "  -p <teste de primalidade: divisao (padrão)|roda|mr>\n"
+           "  -F <trecho> (simula a queda do processo que o contar, para testar a reatribuição)\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+
+  N = atoll(argv[optind]);
+  nProcs = atoi(argv[optind + 1]);
+  if (nProcs < 1 || nProcs > MAX_PROCS){
+    printf("ERRO: Número de processos inválido (de 1 a %d)!\n", MAX_PROCS);
+    exit(EXIT_FAILURE);
+  }
+
+  if (!strcmp(politica, "numa")){
+    numa = 1;
+    nNos = contaNos();
+    afinidade.policy = AFF_NONE;
+    afinidade.nCpus = 0;
+  }
+  else if (affinityParse(politica, &afinidade)){
+    printf("ERRO: Política de afinidade inválida!\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // Segmento compartilhado: cabeçalho, tabela de processos e estado dos trechos
+  tamTrecho = (N + (long long int)nProcs * TRECHOS_POR_PROC - 1) / ((long long int)nProcs * TRECHOS_POR_PROC);
+  if (tamTrecho < 1)
+    tamTrecho = 1;
+  int nTrechos = N > 0 ? (int)((N + tamTrecho - 1) / tamTrecho) : 0;
+  tamanho = sizeof(t_compartilhado) + nTrechos * sizeof(t_trecho);
+
+  snprintf(nome, sizeof(nome), "/contPrimosMP.%d", (int)getpid());
+  if ((fd = shm_open(nome, O_CREAT | O_EXCL | O_RDWR, 0600)) < 0){
+    printf("ERRO: Impossível criar o segmento compartilhado %s!\n", nome);
+    exit(EXIT_FAILURE);
+  }
+  if (ftruncate(fd, tamanho)){
+    printf("ERRO: Impossível dimensionar o segmento compartilhado %s!\n", nome);
+    close(fd);
+    shm_unlink(nome);
+    exit(EXIT_FAILURE);
+  }
+  shm = (t_compartilhado*)mmap(NULL, tamanho, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  // Os filhos herdam o mapeamento pelo fork, então o nome já pode sair: nada fica em /dev/shm mesmo se o programa morrer
+  shm_unlink(nome);
+  if (shm == MAP_FAILED){
+    printf("ERRO: Impossível mapear o segmento compartilhado!\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // O segmento novo vem zerado; só o que não começa em 0 é inicializado
+  shm->N = N;
+  shm->tamTrecho = tamTrecho;
+  shm->nTrechos = nTrechos;
+  atomic_init(&shm->falhaSimulada, trechoFalha >= 0);
+  atomic_init(&shm->cursor, 0);
+  for (int t = 0; t < nTrechos; t++)
+    atomic_init(&shm->trechos[t].estado, TRECHO_LIVRE);
+  for (int p = 0; p <= nProcs; p++)
+    shm->procs[p].no = numa && p < nProcs ? p % nNos : -1;
+
+  GET_TIME(inicio);
+
+  // Criando processos trabalhadores
+  for (int p = 0; p < nProcs; p++)
+    if ((shm->procs[p].pid = criaTrabalhador(p, numa, nNos, &afinidade)) < 0){
+      printf("ERRO: Impossível criar processo trabalhador!\n");
+      // Não deixa órfãos os trabalhadores já criados
+      for (int q = 0; q < p; q++)
+        kill(shm->procs[q].pid, SIGKILL);
+      for (int q = 0; q < p; q++)
+        waitpid(shm->procs[q].pid, NULL, 0);
+      munmap(shm, tamanho);
+      exit(EXIT_FAILURE);
+    }
+  vivos = nProcs;
+
+  // Coordenação: espera os processos; se um cai, seus trechos inacabados viram órfãos e outro ocupa o lugar
+  while (vivos > 0){
+    int estado, p;
+    pid_t pid = wait(&estado);
+
+    if (pid < 0)
+      break;
+    for (p = 0; p < nProcs && shm->procs[p].pid != pid; p++);
+    if (p == nProcs)
+      continue;
+    vivos--;
+
+    if (WIFEXITED(estado) && WEXITSTATUS(estado) == EXIT_SUCCESS)
+      continue;
+
+    shm->procs[p].quedas++;
+    for (int t = 0; t < nTrechos; t++){
+      int dono = p;
+      atomic_compare_exchange_strong(&shm->trechos[t].estado, &dono, TRECHO_ORFAO);
+    }
+    fprintf(stderr, "Processo %d (pid %d) caiu; seus trechos inacabados foram reatribuídos\n", p + 1, (int)pid);
+
+    if (shm->procs[p].quedas <= MAX_REINICIOS && (shm->procs[p].pid = criaTrabalhador(p, numa, nNos, &afinidade)) > 0)
+      vivos++;
+  }
+
+  // Varredura final no coordenador: sobras de lugares que esgotaram os reinícios
+  trabalha(nProcs);
+
+  GET_TIME(fim);
+
+  for (int t = 0; t < nTrechos; t++)
+    totPrimos += shm->trechos[t].contagem;
+
+  printf("Total de primos até %lld: %lld\n", N, totPrimos);
+  printf("Tempo (modo multiprocesso): %lf s, %.0f inteiros/s\n", fim - inicio, N / (fim - inicio));
+
+  printf("Contagens de primos por processo:\n");
+  for (int p = 0; p < nProcs; p++)
+    printf("Processo %d) %lld (%d trechos, nó %d, %d quedas)\n", p + 1, (long long int)atomic_load(&shm->procs[p].contagem),
+           atomic_load(&shm->procs[p].trechos), shm->procs[p].no, shm->procs[p].quedas);
+  if (atomic_load(&shm->procs[nProcs].trechos))
+    printf("Coordenador) %lld (%d trechos)\n", (long long int)atomic_load(&shm->procs[nProcs].contagem),
+           atomic_load(&shm->procs[nProcs].trechos));
+
+  munmap(shm, tamanho);
+  return 0;
+}
\ No newline at end of file
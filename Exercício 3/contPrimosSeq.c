@@ -1,12 +1,19 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include "crivo.h"
+#include "millerRabin.h"
+#include "roda.h"
+#include "lucy.h"
+
+#define LIMITE_CONFERE 100000000LL // Até aqui, o resultado do modo lucy é conferido com o crivo
 
 // Função verificadora de primos
 int ehPrimo(long long int n) {
   if (n <= 1) return 0;
   if (n == 2) return 1;
   if (n%2 == 0) return 0;
-  for (int i = 3; i*i <= n; i += 2)
+  for (long long int i = 3; i <= n / i; i += 2) // `i <= n/i` não estoura, ao contrário de `i*i <= n`
     if (n%i == 0) return 0;
   return 1;
 }
@@ -17,15 +24,60 @@ int main(int argc, char* argv[]){
 
   if (argc < 2){
     printf("ERRO: Há argumento faltante!\n"
-           "Tente %s <nº de inteiros N>\n", argv[0]);
+           "Tente %s <nº de inteiros N> [modo: divisao|crivo|mr|roda|lucy (OPCIONAL, padrão divisao)] "
+           "[nº de threads (OPCIONAL, só no modo lucy)]\n", argv[0]);
     exit(EXIT_FAILURE);
   }
 
   N = atoll(argv[1]);
 
-  for (long long int i = 1; i <= N; i++)
-    if (ehPrimo(i))
-      contPrimos++;
+  if (argc > 2 && !strcmp(argv[2], "crivo")){
+    // Crivo segmentado, sem criar threads
+    if ((contPrimos = crivoConta(N, 1, NULL, NULL)) < 0){
+      printf("ERRO: Impossível alocar memória para o crivo!\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+  else if (argc > 2 && !strcmp(argv[2], "mr")){
+    // Miller–Rabin determinístico em cada inteiro
+    for (long long int i = 1; i <= N; i++)
+      if (ehPrimoMR(i))
+        contPrimos++;
+  }
+  else if (argc > 2 && !strcmp(argv[2], "lucy")){
+    // π(N) sublinear, sem enumerar os inteiros
+    int nThreads = argc > 3 ? atoi(argv[3]) : 1;
+
+    if (nThreads < 1){
+      printf("ERRO: Número de threads inválido!\n");
+      exit(EXIT_FAILURE);
+    }
+    if ((contPrimos = piLucy(N, nThreads)) < 0){
+      printf("ERRO: Impossível alocar memória para o método de Lucy!\n");
+      exit(EXIT_FAILURE);
+    }
+
+    // Para N pequeno, confere com a enumeração do crivo
+    if (N <= LIMITE_CONFERE && crivoConta(N, 1, NULL, NULL) != contPrimos){
+      printf("ERRO: π(%lld) pelo método de Lucy (%lld) difere da enumeração!\n", N, contPrimos);
+      exit(EXIT_FAILURE);
+    }
+  }
+  else if (argc > 2 && !strcmp(argv[2], "roda")){
+    // Divisão só pelos primos, e só dos candidatos da roda 2·3·5·7
+    for (long long int i = rodaProximo(0); i <= N; i = rodaProximo(i))
+      if (ehPrimoRoda(i))
+        contPrimos++;
+  }
+  else if (argc > 2 && strcmp(argv[2], "divisao")){
+    printf("ERRO: Modo inválido!\n");
+    exit(EXIT_FAILURE);
+  }
+  else {
+    for (long long int i = 1; i <= N; i++)
+      if (ehPrimo(i))
+        contPrimos++;
+  }
 
   printf("Contagem de primos até %lld: %lld\n", N, contPrimos);
   
@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "affinity.h"
+#include "crivo.h"
+#include "indice.h"
+#include "timer.h"
+
+// Índice persistente de primos: constrói (ou estende) o índice em arquivo até N e responde, para cada linha
+// "a b" lida da entrada padrão, quantos primos há em [a, b]. Consultas além do índice o estendem.
+int main(int argc, char* argv[]){
+  t_indice indice;
+  long long int N = 0, a, b, contagem;
+  int nThreads = 1;
+  int nConsultas = 0;
+  double inicio, fim, tempoConsultas = 0;
+
+  if (argc < 2){
+    printf("ERRO: Há argumento faltante!\n"
+           "Tente %s <arquivo do índice> [N a indexar (OPCIONAL)] [nº de threads do crivo (OPCIONAL, padrão 1)]\n"
+           "e passe as consultas \"a b\" pela entrada padrão, uma por linha\n", argv[0]);
+    exit(EXIT_FAILURE);
+  }
+
+  if (argc > 2)
+    N = atoll(argv[2]);
+  if (argc > 3)
+    nThreads = atoi(argv[3]);
+  if (nThreads < 1){
+    printf("ERRO: Número de threads inválido!\n");
+    exit(EXIT_FAILURE);
+  }
+
+  if (indiceAbre(&indice, argv[1], nThreads, NULL) != 0){
+    printf("ERRO: Impossível abrir o índice em %s!\n", argv[1]);
+    exit(EXIT_FAILURE);
+  }
+
+  // Construção: só o trecho além do que o arquivo já tinha é crivado
+  if (N > indiceLimite(&indice)){
+    long long int anterior = indiceLimite(&indice);
+
+    GET_TIME(inicio);
+    if (indiceEstende(&indice, N) != 0){
+      printf("ERRO: Impossível estender o índice até %lld!\n", N);
+      exit(EXIT_FAILURE);
+    }
+    GET_TIME(fim);
+    fprintf(stderr, "Índice estendido de %lld até %lld em %lf s\n", anterior, indiceLimite(&indice), fim - inicio);
+  }
+
+  // Consultas: uma busca de prefixo e um popcount parcial em cada extremo
+  while (scanf("%lld %lld", &a, &b) == 2){
+    GET_TIME(inicio);
+    contagem = indiceConta(&indice, a, b);
+    GET_TIME(fim);
+    tempoConsultas += fim - inicio;
+
+    if (contagem < 0){
+      printf("ERRO: Impossível estender o índice até %lld!\n", b);
+      exit(EXIT_FAILURE);
+    }
+    printf("%lld %lld %lld\n", a, b, contagem);
+    nConsultas++;
+  }
+
+  fprintf(stderr, "%d consultas em %lf s (índice até %lld)\n", nConsultas, tempoConsultas, indiceLimite(&indice));
+
+  indiceFecha(&indice);
+  return 0;
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "checkpoint.h"
+
+#define MAGICO "CPCKPT01" // Identifica o arquivo de checkpoint (8 bytes)
+
+// Cabeçalho do arquivo
+typedef struct {
+  char magico[8];
+  long long int N;
+  long long int tamTrecho;
+  long long int nTrechos;
+} t_cabecalho;
+
+int checkpointGrava(const char* arquivo, long long int N, long long int tamTrecho, int nTrechos, const long long int* contagens){
+  t_cabecalho cab;
+  char temporario[strlen(arquivo) + 5];
+  FILE* arq;
+  int erro;
+
+  memset(&cab, 0, sizeof(cab));
+  memcpy(cab.magico, MAGICO, 8);
+  cab.N = N;
+  cab.tamTrecho = tamTrecho;
+  cab.nTrechos = nTrechos;
+
+  snprintf(temporario, sizeof(temporario), "%s.tmp", arquivo);
+  if (!(arq = fopen(temporario, "wb")))
+    return -1;
+
+  // Os dados chegam ao disco antes do rename, que troca o checkpoint antigo pelo novo de uma vez
+  erro = fwrite(&cab, sizeof(cab), 1, arq) != 1
+      || fwrite(contagens, sizeof(long long int), nTrechos, arq) != (size_t)nTrechos
+      || fflush(arq) != 0 || fsync(fileno(arq)) != 0;
+  erro = fclose(arq) != 0 || erro;
+
+  if (erro || rename(temporario, arquivo) != 0){
+    remove(temporario);
+    return -1;
+  }
+  return 0;
+}
+
+int checkpointLe(const char* arquivo, long long int N, long long int* tamTrecho, int* nTrechos, long long int* contagens){
+  t_cabecalho cab;
+  FILE* arq = fopen(arquivo, "rb");
+  int erro;
+
+  if (!arq)
+    return -1;
+
+  erro = fread(&cab, sizeof(cab), 1, arq) != 1 || memcmp(cab.magico, MAGICO, 8) || cab.N != N
+      || cab.tamTrecho < 1 || cab.nTrechos < 1 || cab.nTrechos > CHECKPOINT_MAX_TRECHOS
+      || (cab.nTrechos - 1) * cab.tamTrecho >= N || cab.nTrechos * cab.tamTrecho < N
+      || fread(contagens, sizeof(long long int), cab.nTrechos, arq) != (size_t)cab.nTrechos;
+  fclose(arq);
+
+  if (erro)
+    return -1;
+  *tamTrecho = cab.tamTrecho;
+  *nTrechos = (int)cab.nTrechos;
+  return 0;
+}
\ No newline at end of file
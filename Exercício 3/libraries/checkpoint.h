@@ -0,0 +1,18 @@
+// Checkpoint de contagens por trechos, para retomar execuções longas
+//
+// O intervalo [1, N] é dividido em trechos fixos de `tamTrecho` inteiros, e o arquivo guarda a contagem de cada
+// trecho já terminado (CHECKPOINT_PENDENTE nos demais), depois de um cabeçalho com N e o tamanho dos trechos.
+// A gravação vai para um arquivo temporário que depois substitui o anterior com rename, então uma interrupção
+// no meio dela deixa o checkpoint antigo intacto.
+
+#pragma once
+
+#define CHECKPOINT_MAX_TRECHOS 4096 // Máximo de trechos de um checkpoint (32 KiB de contagens)
+#define CHECKPOINT_PENDENTE (-1LL) // Contagem de um trecho ainda não terminado
+
+// Grava as `nTrechos` contagens de trechos em `arquivo`; devolve 0 ou -1 em caso de erro
+int checkpointGrava(const char* arquivo, long long int N, long long int tamTrecho, int nTrechos, const long long int* contagens);
+
+// Lê o checkpoint em `arquivo`, que precisa ser de uma execução até o mesmo N; `contagens` deve ter espaço para
+// CHECKPOINT_MAX_TRECHOS. Devolve 0, ou -1 se o arquivo não pôde ser lido, está corrompido ou é de outro N.
+int checkpointLe(const char* arquivo, long long int N, long long int* tamTrecho, int* nTrechos, long long int* contagens);
\ No newline at end of file
@@ -0,0 +1,241 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "crivo.h"
+
+#define SEG_BITS (CRIVO_SEG_BYTES * 8LL) // Ímpares representados em cada segmento
+#define SEG_PALAVRAS (CRIVO_SEG_BYTES / 8) // Palavras de 64 bits de cada segmento
+#define PERIODO_PRE 15015 // 3·5·7·11·13: período (em palavras de 64 bits) do padrão de pré-crivo
+
+static const int preCrivados[] = {3, 5, 7, 11, 13}; // Primos cujos múltiplos vêm do padrão
+#define NPRE ((int)(sizeof(preCrivados) / sizeof(preCrivados[0])))
+
+// Estado compartilhado por todas as threads de um crivo
+typedef struct {
+  long long int base; // Primeiro índice crivado (múltiplo de 64)
+  long long int fimImpares; // Índice seguinte ao último crivado
+  long long int nSegs; // Quantidade de segmentos
+  uint64_t* mapa; // Se não for NULL, recebe os bits do intervalo (1 = primo)
+  uint32_t* primos; // Primos base (maiores que 13 e até √N)
+  int nPrimos;
+  uint64_t* padrao; // Padrão de pré-crivo (PERIODO_PRE palavras)
+  atomic_llong proxSeg; // Próximo segmento ainda não reservado
+} t_crivo;
+
+// Argumentos de cada thread do crivo
+typedef struct {
+  t_crivo* crivo;
+  long long int contagem; // Primos encontrados pela thread
+} t_trabalhador;
+
+// Raiz quadrada inteira (maior r com r² <= n), pelo método de Newton
+static long long int raizInteira(long long int n){
+  long long int r = n, prox;
+
+  if (n < 2)
+    return n;
+  prox = (r + 1) / 2;
+  while (prox < r){
+    r = prox;
+    prox = (r + n / r) / 2;
+  }
+  return r;
+}
+
+// Primos ímpares maiores que 13 e até `limite`, por um crivo simples (devolve NULL se faltar memória)
+static uint32_t* primosBase(long long int limite, int* nPrimos){
+  char* composto = (char*)calloc(limite + 1, 1);
+  uint32_t* primos = (uint32_t*)malloc((limite / 2 + 1) * sizeof(uint32_t));
+
+  *nPrimos = 0;
+  if (!composto || !primos){
+    free(composto);
+    free(primos);
+    return NULL;
+  }
+
+  for (long long int i = 3; i <= limite; i += 2){
+    if (composto[i])
+      continue;
+    if (i > 13)
+      primos[(*nPrimos)++] = (uint32_t)i;
+    for (long long int j = i * i; j <= limite; j += 2 * i)
+      composto[j] = 1;
+  }
+
+  free(composto);
+  return primos;
+}
+
+// Padrão periódico com os múltiplos de 3, 5, 7, 11 e 13 já marcados (o bit b da palavra w é o índice 64w + b)
+static uint64_t* padraoPreCrivo(){
+  uint64_t* padrao = (uint64_t*)calloc(PERIODO_PRE, sizeof(uint64_t));
+
+  if (!padrao)
+    return NULL;
+
+  for (int i = 0; i < NPRE; i++){
+    int p = preCrivados[i];
+    // 2k + 1 ≡ 0 (mod p) a partir de k = (p - 1)/2, com passo p
+    for (long long int k = (p - 1) / 2; k < 64LL * PERIODO_PRE; k += p)
+      padrao[k >> 6] |= 1ULL << (k & 63);
+  }
+
+  return padrao;
+}
+
+// Crivo do segmento `s` (ímpares de índice base + [s·SEG_BITS, (s+1)·SEG_BITS)) em `bits`; devolve quantos primos ímpares há nele
+static long long int crivaSegmento(t_crivo* crivo, long long int s, uint64_t* bits){
+  long long int inicio = crivo->base + s * SEG_BITS; // Primeiro índice do segmento
+  long long int nBits = crivo->fimImpares - inicio < SEG_BITS ? crivo->fimImpares - inicio : SEG_BITS;
+  long long int fim = inicio + nBits;
+  int nPalavras = (int)((nBits + 63) / 64);
+  long long int contagem = 0;
+  int off = (int)((inicio / 64) % PERIODO_PRE);
+
+  // Pré-crivo: copia o padrão a partir da posição global do segmento (base e SEG_BITS são múltiplos de 64)
+  for (int w = 0; w < nPalavras; w++){
+    bits[w] = crivo->padrao[off];
+    if (++off == PERIODO_PRE)
+      off = 0;
+  }
+
+  // Marca os múltiplos ímpares de cada primo base, a partir de p² (índice (p² - 1)/2), com passo p
+  for (int i = 0; i < crivo->nPrimos; i++){
+    long long int p = crivo->primos[i];
+    long long int j = (p * p - 1) / 2;
+
+    if (j >= fim)
+      break; // Primos em ordem crescente: os demais também começam depois do segmento
+    if (j < inicio)
+      j += (inicio - j + p - 1) / p * p;
+    for (j -= inicio; j < nBits; j += p)
+      bits[j >> 6] |= 1ULL << (j & 63);
+  }
+
+  // Bits além do fim contam como compostos
+  if (nBits % 64)
+    bits[nPalavras - 1] |= ~0ULL << (nBits % 64);
+
+  // Correções do começo dos ímpares: 1 não é primo e os pré-crivados foram marcados pelo padrão
+  if (inicio == 0){
+    bits[0] |= 1;
+    for (int i = 0; i < NPRE; i++)
+      if ((preCrivados[i] - 1) / 2 < nBits)
+        bits[0] &= ~(1ULL << ((preCrivados[i] - 1) / 2));
+  }
+
+  for (int w = 0; w < nPalavras; w++)
+    contagem += __builtin_popcountll(~bits[w]);
+
+  if (crivo->mapa)
+    for (int w = 0; w < nPalavras; w++)
+      crivo->mapa[(inicio - crivo->base) / 64 + w] = ~bits[w];
+
+  return contagem;
+}
+
+// Corpo das threads do crivo: reservam segmentos até acabarem (uma thread sem memória só não participa)
+static void* trabalhaCrivo(void* args){
+  t_trabalhador* trab = (t_trabalhador*)args;
+  t_crivo* crivo = trab->crivo;
+  uint64_t* bits = (uint64_t*)aligned_alloc(64, CRIVO_SEG_BYTES);
+  long long int s;
+
+  trab->contagem = 0;
+  if (!bits)
+    return NULL;
+
+  while ((s = atomic_fetch_add_explicit(&crivo->proxSeg, 1, memory_order_relaxed)) < crivo->nSegs)
+    trab->contagem += crivaSegmento(crivo, s, bits);
+
+  free(bits);
+  return NULL;
+}
+
+// Prepara o crivo dos índices [base, fim) e o executa com `nThreads` threads (ver crivoConta)
+static long long int executaCrivo(long long int base, long long int fim, uint64_t* mapa, int nThreads, long long int* contagens, const t_affinity* afinidade){
+  t_crivo crivo;
+  t_trabalhador trabs[nThreads];
+  pthread_t tids[nThreads];
+  pthread_attr_t attr, *attrPtr;
+  long long int total = 0;
+  int criadas = 0;
+
+  crivo.base = base;
+  crivo.fimImpares = fim;
+  crivo.nSegs = (fim - base + SEG_BITS - 1) / SEG_BITS;
+  crivo.mapa = mapa;
+  crivo.primos = primosBase(raizInteira(2 * fim - 1), &crivo.nPrimos);
+  crivo.padrao = padraoPreCrivo();
+  atomic_init(&crivo.proxSeg, 0);
+
+  if (!crivo.primos || !crivo.padrao){
+    free(crivo.primos);
+    free(crivo.padrao);
+    return -1;
+  }
+
+  // A thread 0 é a própria chamadora; as demais são criadas (se alguma falhar, as outras crivam sua parte)
+  for (int t = 0; t < nThreads; t++)
+    trabs[t].crivo = &crivo;
+  for (int t = 1; t < nThreads; t++){
+    int erro;
+    attrPtr = affinityAttr(afinidade, t, &attr);
+    erro = pthread_create(&tids[t], attrPtr, trabalhaCrivo, &trabs[t]);
+    if (attrPtr)
+      pthread_attr_destroy(attrPtr);
+    if (erro)
+      break;
+    criadas++;
+  }
+  affinityPinSelf(afinidade, 0);
+  trabalhaCrivo(&trabs[0]);
+
+  for (int t = 1; t <= criadas; t++)
+    pthread_join(tids[t], NULL);
+
+  for (int t = 0; t <= criadas; t++){
+    total += trabs[t].contagem;
+    if (contagens)
+      contagens[t] = trabs[t].contagem;
+  }
+  for (int t = criadas + 1; t < nThreads && contagens; t++)
+    contagens[t] = 0;
+
+  free(crivo.primos);
+  free(crivo.padrao);
+
+  // Segmentos que sobraram: nenhuma thread conseguiu alocar memória
+  return atomic_load(&crivo.proxSeg) < crivo.nSegs ? -1 : total;
+}
+
+long long int crivoConta(long long int N, int nThreads, long long int* contagens, const t_affinity* afinidade){
+  long long int total;
+
+  if (N < 1){
+    if (contagens)
+      memset(contagens, 0, nThreads * sizeof(long long int));
+    return 0;
+  }
+
+  total = executaCrivo(0, (N + 1) / 2, NULL, nThreads, contagens, afinidade);
+
+  // 2 não é ímpar: fica na conta da thread chamadora
+  if (total >= 0 && N >= 2){
+    total++;
+    if (contagens)
+      contagens[0]++;
+  }
+  return total;
+}
+
+long long int crivoMapa(long long int inicio, long long int n, uint64_t* mapa, int nThreads, const t_affinity* afinidade){
+  if (inicio % 64 || n < 0)
+    return -1;
+  if (n == 0)
+    return 0;
+  return executaCrivo(inicio, inicio + n, mapa, nThreads, NULL, afinidade);
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+// Crivo de Eratóstenes segmentado e paralelo para contagem de primos
+//
+// Só os ímpares são representados (o índice k corresponde a n = 2k + 1), um bit por ímpar (1 = composto),
+// em segmentos do tamanho da cache L1, que as threads reservam dinamicamente. Os múltiplos de 3, 5, 7, 11 e 13
+// são pré-crivados copiando um padrão periódico, e só os demais primos até √N são marcados um a um.
+//
+// Compilar com -I"../Exercício 1/libraries" e ligar com affinity.c.
+
+#pragma once
+
+#include <stdint.h>
+#include "affinity.h"
+
+#define CRIVO_SEG_BYTES 32768 // Tamanho (em bytes) de cada segmento do crivo (cabe na L1)
+
+// Conta os primos em [1, N] com `nThreads` threads (com 1, roda na própria thread chamadora).
+// Se `contagens` não for NULL, recebe a contagem de primos dos segmentos crivados por cada thread.
+// `afinidade` (pode ser NULL) fixa a thread i na i-ésima CPU da política.
+// Devolve o total de primos, ou -1 se não foi possível alocar memória.
+long long int crivoConta(long long int N, int nThreads, long long int* contagens, const t_affinity* afinidade);
+
+// Crivo dos ímpares de índice [inicio, inicio + n) (o índice k é o ímpar 2k + 1), com `inicio` múltiplo de 64.
+// Escreve em `mapa` (⌈n/64⌉ palavras) um bit por ímpar (1 = primo, o bit b da palavra w é o índice inicio + 64w + b).
+// Devolve quantos primos ímpares há no intervalo, ou -1 se `inicio` não é múltiplo de 64 ou faltou memória.
+long long int crivoMapa(long long int inicio, long long int n, uint64_t* mapa, int nThreads, const t_affinity* afinidade);
\ No newline at end of file
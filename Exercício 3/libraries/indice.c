@@ -0,0 +1,189 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "crivo.h"
+#include "indice.h"
+
+#define MAGICO "PRIMIDX1" // Identifica o arquivo de índice (8 bytes)
+#define TAM_CABECALHO 64 // Cabeçalho ocupa uma linha de cache, e os blocos continuam alinhados
+#define LOTE_BLOCOS (1 << 16) // Blocos crivados e gravados de cada vez numa extensão (4 MiB)
+#define EXTENSAO_MIN (1 << 14) // Uma extensão pedida por consulta acrescenta pelo menos esses blocos
+
+// Cabeçalho do arquivo
+typedef struct {
+  char magico[8];
+  uint64_t nBlocos; // Blocos completos (só é atualizado depois que os blocos foram gravados)
+  uint64_t reservado[6];
+} t_cabecalho;
+
+// Desfaz o mapeamento atual (se houver) e mapeia os `nBlocos` primeiros blocos do arquivo em memória
+static int mapeia(t_indice* indice, uint64_t nBlocos){
+  void* mem;
+
+  if (indice->blocos)
+    munmap((char*)indice->blocos - TAM_CABECALHO, TAM_CABECALHO + indice->nBlocos * sizeof(t_bloco_indice));
+  indice->blocos = NULL;
+  indice->nBlocos = nBlocos;
+  if (nBlocos == 0)
+    return 0;
+
+  mem = mmap(NULL, TAM_CABECALHO + indice->nBlocos * sizeof(t_bloco_indice), PROT_READ, MAP_SHARED, indice->fd, 0);
+  if (mem == MAP_FAILED){
+    indice->nBlocos = 0;
+    return -1;
+  }
+  indice->blocos = (t_bloco_indice*)((char*)mem + TAM_CABECALHO);
+  return 0;
+}
+
+// Grava o cabeçalho com a quantidade de blocos atual
+static int gravaCabecalho(t_indice* indice){
+  t_cabecalho cab;
+
+  memset(&cab, 0, sizeof(cab));
+  memcpy(cab.magico, MAGICO, 8);
+  cab.nBlocos = indice->nBlocos;
+  return pwrite(indice->fd, &cab, sizeof(cab), 0) == sizeof(cab) ? 0 : -1;
+}
+
+int indiceAbre(t_indice* indice, const char* arquivo, int nThreads, const t_affinity* afinidade){
+  t_cabecalho cab;
+  struct stat st;
+  ssize_t lidos;
+
+  indice->blocos = NULL;
+  indice->nBlocos = 0;
+  indice->nThreads = nThreads;
+  indice->afinidade = afinidade;
+
+  if ((indice->fd = open(arquivo, O_RDWR | O_CREAT, 0644)) < 0)
+    return -1;
+
+  lidos = pread(indice->fd, &cab, sizeof(cab), 0);
+  if (lidos == 0){
+    // Arquivo novo: só o cabeçalho, sem blocos
+    if (gravaCabecalho(indice) == 0)
+      return 0;
+  }
+  else if (lidos == sizeof(cab) && !memcmp(cab.magico, MAGICO, 8) && fstat(indice->fd, &st) == 0
+           && (uint64_t)st.st_size >= TAM_CABECALHO + cab.nBlocos * sizeof(t_bloco_indice)){
+    if (mapeia(indice, cab.nBlocos) == 0)
+      return 0;
+  }
+
+  close(indice->fd);
+  indice->fd = -1;
+  return -1;
+}
+
+void indiceFecha(t_indice* indice){
+  if (indice->fd < 0)
+    return;
+  mapeia(indice, 0);
+  close(indice->fd);
+  indice->fd = -1;
+}
+
+long long int indiceLimite(const t_indice* indice){
+  // O último ímpar indexado é 2·(nBlocos·INDICE_IMPARES) - 1, e o par seguinte não muda a contagem
+  return (long long int)indice->nBlocos * 2 * INDICE_IMPARES;
+}
+
+int indiceEstende(t_indice* indice, long long int N){
+  uint64_t alvo = (N + 2 * INDICE_IMPARES - 1) / (2 * INDICE_IMPARES); // Blocos para cobrir [1, N]
+  uint64_t antes = 0;
+  uint64_t b;
+  uint64_t* mapa;
+  t_bloco_indice* lote;
+
+  if (N <= indiceLimite(indice))
+    return 0;
+
+  mapa = (uint64_t*)malloc((size_t)LOTE_BLOCOS * INDICE_PALAVRAS * sizeof(uint64_t));
+  lote = (t_bloco_indice*)malloc((size_t)LOTE_BLOCOS * sizeof(t_bloco_indice));
+  if (!mapa || !lote){
+    free(mapa);
+    free(lote);
+    return -1;
+  }
+
+  // A contagem continua de onde o último bloco parou
+  if (indice->nBlocos > 0){
+    const t_bloco_indice* ultimo = &indice->blocos[indice->nBlocos - 1];
+    antes = ultimo->antes;
+    for (int w = 0; w < INDICE_PALAVRAS; w++)
+      antes += __builtin_popcountll(ultimo->bits[w]);
+  }
+
+  // Crivo só do trecho novo, em lotes, gravados no fim do arquivo
+  for (b = indice->nBlocos; b < alvo; b += LOTE_BLOCOS){
+    uint64_t nLote = alvo - b < LOTE_BLOCOS ? alvo - b : LOTE_BLOCOS;
+    size_t tam = nLote * sizeof(t_bloco_indice);
+
+    if (crivoMapa((long long int)b * INDICE_IMPARES, (long long int)nLote * INDICE_IMPARES, mapa,
+                  indice->nThreads, indice->afinidade) < 0)
+      break;
+
+    for (uint64_t i = 0; i < nLote; i++){
+      lote[i].antes = antes;
+      for (int w = 0; w < INDICE_PALAVRAS; w++){
+        lote[i].bits[w] = mapa[i * INDICE_PALAVRAS + w];
+        antes += __builtin_popcountll(lote[i].bits[w]);
+      }
+    }
+
+    if (pwrite(indice->fd, lote, tam, TAM_CABECALHO + b * sizeof(t_bloco_indice)) != (ssize_t)tam)
+      break;
+  }
+
+  free(mapa);
+  free(lote);
+
+  // O cabeçalho só passa a contar os blocos novos depois que todos foram gravados (se algo falhou no meio,
+  // os blocos a mais no fim do arquivo são ignorados e regravados na próxima extensão)
+  if (b < alvo || fdatasync(indice->fd) != 0)
+    return -1;
+  if (mapeia(indice, alvo) != 0)
+    return -1;
+  return gravaCabecalho(indice);
+}
+
+long long int indicePi(const t_indice* indice, long long int n){
+  long long int k, contagem;
+  const t_bloco_indice* bloco;
+  int j, w;
+
+  if (n < 2)
+    return 0;
+
+  // Maior ímpar <= n tem índice (n - 1)/2; o prefixo do bloco mais o popcount parcial dão os ímpares primos
+  k = (n - 1) / 2;
+  bloco = &indice->blocos[k / INDICE_IMPARES];
+  j = (int)(k % INDICE_IMPARES);
+  contagem = (long long int)bloco->antes;
+  for (w = 0; w < j / 64; w++)
+    contagem += __builtin_popcountll(bloco->bits[w]);
+  contagem += __builtin_popcountll(bloco->bits[w] & ((2ULL << (j % 64)) - 1));
+
+  return contagem + 1; // O primo 2
+}
+
+long long int indiceConta(t_indice* indice, long long int a, long long int b){
+  if (a < 1)
+    a = 1;
+  if (b < a)
+    return 0;
+
+  // Estende com alguma folga, para que uma sequência de consultas crescentes não crive aos pedacinhos
+  if (b > indiceLimite(indice)){
+    long long int folga = indiceLimite(indice) + (long long int)EXTENSAO_MIN * 2 * INDICE_IMPARES;
+    if (indiceEstende(indice, b > folga ? b : folga) != 0)
+      return -1;
+  }
+
+  return indicePi(indice, b) - indicePi(indice, a - 1);
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+// Índice persistente de primos em arquivo, para consultas de contagem em intervalos
+//
+// O arquivo guarda o mapa de bits dos ímpares (o índice k corresponde a n = 2k + 1, 1 = primo) em blocos de
+// 64 bytes (uma linha de cache): cada bloco tem a quantidade de primos ímpares antes dele, seguida de 7 palavras
+// de 64 bits do mapa (448 ímpares). Assim, π(n) sai de uma consulta ao prefixo do bloco mais um popcount parcial,
+// tudo na mesma linha de cache. O arquivo é mapeado em memória com mmap e, quando uma consulta passa do
+// intervalo indexado, é estendido com blocos novos no fim (crivando só o trecho novo), sem refazer o resto.
+//
+// Compilar com -I"../Exercício 1/libraries" e ligar com crivo.c e affinity.c.
+
+#pragma once
+
+#include <stdint.h>
+#include "affinity.h"
+
+#define INDICE_PALAVRAS 7 // Palavras do mapa em cada bloco
+#define INDICE_IMPARES (64 * INDICE_PALAVRAS) // Ímpares representados em cada bloco
+
+// Bloco do arquivo: ocupa exatamente uma linha de cache
+typedef struct {
+  uint64_t antes; // Primos ímpares com índice menor que o primeiro do bloco
+  uint64_t bits[INDICE_PALAVRAS];
+} t_bloco_indice;
+
+// Índice aberto
+typedef struct {
+  int fd;
+  uint64_t nBlocos; // Blocos completos no arquivo
+  t_bloco_indice* blocos; // Blocos mapeados em memória (NULL se não há nenhum)
+  int nThreads; // Threads usadas para crivar as extensões
+  const t_affinity* afinidade; // Afinidade dessas threads (pode ser NULL)
+} t_indice;
+
+// Abre (criando, se não existir) o índice em `arquivo`; as extensões são crivadas com `nThreads` threads.
+// Devolve 0 em caso de sucesso, -1 se o arquivo não pôde ser aberto ou não é um índice.
+int indiceAbre(t_indice* indice, const char* arquivo, int nThreads, const t_affinity* afinidade);
+
+// Fecha o índice (o arquivo continua valendo para aberturas futuras)
+void indiceFecha(t_indice* indice);
+
+// Maior n coberto pelo índice (0 se ainda vazio)
+long long int indiceLimite(const t_indice* indice);
+
+// Estende o índice até cobrir pelo menos [1, N] (não faz nada se já cobre); devolve 0 ou -1 em caso de erro
+int indiceEstende(t_indice* indice, long long int N);
+
+// π(n), a quantidade de primos em [1, n]; n precisa estar coberto pelo índice
+long long int indicePi(const t_indice* indice, long long int n);
+
+// Quantidade de primos em [a, b], estendendo o índice se b passa do limite; devolve -1 em caso de erro
+long long int indiceConta(t_indice* indice, long long int a, long long int b);
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include "lucy.h"
+
+#define MIN_PARALELO (1 << 15) // Atualizações de um primo a partir das quais vale dividi-las entre as threads
+#define MAX_THREADS 256 // Limite de threads do método (os vetores delas ficam na pilha)
+
+// Estado compartilhado pelas threads do método
+typedef struct {
+  long long int x;
+  long long int r; // ⌊√x⌋
+  long long int* peq; // peq[v] = S(v), para v = 1..r
+  long long int* gde; // gde[i] = S(x/i), para i = 1..r (só os i ímpares são usados)
+  long long int* novo; // Valores novos de gde[1..lim], calculados antes de qualquer escrita
+  int nThreads;
+  sem_t largada; // Libera as auxiliares quando a barreira já está pronta
+  pthread_barrier_t barreira;
+  long long int p; // Primo da rodada atual (0 encerra as threads auxiliares)
+  long long int sp; // S(p - 1): quantidade de primos menores que p
+  long long int lim; // Quantidade de valores grandes atualizados na rodada
+} t_lucy;
+
+typedef struct {
+  t_lucy* lucy;
+  int id;
+} t_trabLucy;
+
+// Raiz quadrada inteira (maior r com r² <= n), pelo método de Newton
+static long long int raizInteira(long long int n){
+  long long int r = n, prox;
+
+  if (n < 2)
+    return n;
+  prox = (r + 1) / 2;
+  while (prox < r){
+    r = prox;
+    prox = (r + n / r) / 2;
+  }
+  return r;
+}
+
+// S(x/(i·p)) antes da rodada do primo p: no vetor de valores grandes se i·p <= r, senão no de pequenos
+static inline long long int valorDividido(const t_lucy* lucy, long long int i, long long int p){
+  long long int d = i * p;
+  return d <= lucy->r ? lucy->gde[d] : lucy->peq[lucy->x / d];
+}
+
+// Rodada paralela do primo p: cada thread calcula sua fatia de gde[1..lim] (lendo só valores antigos),
+// espera todas terminarem e só então escreve a fatia de volta
+static void rodadaParalela(t_lucy* lucy, int id){
+  long long int fatia = (lucy->lim + lucy->nThreads - 1) / lucy->nThreads;
+  long long int ini = (1 + id * fatia) | 1; // Primeiro ímpar da fatia
+  long long int fim = id * fatia + fatia < lucy->lim ? id * fatia + fatia : lucy->lim;
+
+  for (long long int i = ini; i <= fim; i += 2)
+    lucy->novo[i] = lucy->gde[i] - (valorDividido(lucy, i, lucy->p) - lucy->sp);
+
+  pthread_barrier_wait(&lucy->barreira);
+
+  for (long long int i = ini; i <= fim; i += 2)
+    lucy->gde[i] = lucy->novo[i];
+}
+
+// Corpo das threads auxiliares: uma rodada paralela a cada primo anunciado pela thread principal
+static void* trabalhaLucy(void* args){
+  t_trabLucy* trab = (t_trabLucy*)args;
+  t_lucy* lucy = trab->lucy;
+
+  sem_wait(&lucy->largada);
+  while (1){
+    pthread_barrier_wait(&lucy->barreira); // Início da rodada
+    if (!lucy->p)
+      break;
+    rodadaParalela(lucy, trab->id);
+    pthread_barrier_wait(&lucy->barreira); // Fim da rodada
+  }
+
+  return NULL;
+}
+
+long long int piLucy(long long int x, int nThreads){
+  t_lucy lucy;
+  long long int pi;
+
+  if (x < 2)
+    return 0;
+
+  lucy.x = x;
+  lucy.r = raizInteira(x);
+
+  // Uma rodada tem no máximo r/2 atualizações, e só é paralela a partir de MIN_PARALELO delas: threads além de
+  // r/MIN_PARALELO ficariam com fatias menores que a metade desse mínimo
+  if (nThreads > lucy.r / MIN_PARALELO)
+    nThreads = lucy.r / MIN_PARALELO;
+  if (nThreads > MAX_THREADS)
+    nThreads = MAX_THREADS;
+  if (nThreads < 1)
+    nThreads = 1;
+
+  pthread_t tids[nThreads];
+  t_trabLucy trabs[nThreads];
+  lucy.peq = (long long int*)malloc((lucy.r + 1) * sizeof(long long int));
+  lucy.gde = (long long int*)malloc((lucy.r + 1) * sizeof(long long int));
+  lucy.novo = nThreads > 1 ? (long long int*)malloc((lucy.r + 1) * sizeof(long long int)) : NULL;
+  if (!lucy.peq || !lucy.gde || (nThreads > 1 && !lucy.novo)){
+    free(lucy.peq);
+    free(lucy.gde);
+    free(lucy.novo);
+    return -1;
+  }
+
+  // Já crivados pelo 2, S(v) = ⌊(v+1)/2⌋ (o 2 e os ímpares de 3 a v) para v >= 2. Como x/i, com i ímpar, só
+  // depende de x/(i·p), com p ímpar, basta manter os valores grandes de i ímpar (metade do trabalho)
+  lucy.peq[1] = 0;
+  for (long long int v = 2; v <= lucy.r; v++)
+    lucy.peq[v] = (v + 1) / 2;
+  for (long long int i = 1; i <= lucy.r; i += 2)
+    lucy.gde[i] = x / i < 2 ? 0 : (x / i + 1) / 2;
+
+  // Threads auxiliares (a principal é a de índice 0); se alguma não puder ser criada, seguem as que foram.
+  // A barreira só é criada depois, com a quantidade certa, e então as auxiliares são liberadas
+  sem_init(&lucy.largada, 0, 0);
+  lucy.nThreads = 1;
+  for (int t = 1; t < nThreads; t++){
+    trabs[t].lucy = &lucy;
+    trabs[t].id = t;
+  }
+  while (lucy.nThreads < nThreads && !pthread_create(&tids[lucy.nThreads], NULL, trabalhaLucy, &trabs[lucy.nThreads]))
+    lucy.nThreads++;
+  pthread_barrier_init(&lucy.barreira, NULL, lucy.nThreads);
+  for (int t = 1; t < lucy.nThreads; t++)
+    sem_post(&lucy.largada);
+
+  for (long long int p = 3; p <= lucy.r; p += 2){
+    long long int sp, p2, lim;
+
+    if (lucy.peq[p] == lucy.peq[p - 1])
+      continue; // p foi eliminado por um primo menor: não é primo
+
+    sp = lucy.peq[p - 1];
+    p2 = p * p;
+    lim = x / p2 < lucy.r ? x / p2 : lucy.r;
+
+    // Valores grandes: S(x/i) -= S(x/(i·p)) - S(p-1)
+    if (lucy.nThreads > 1 && lim / 2 >= MIN_PARALELO){
+      lucy.p = p;
+      lucy.sp = sp;
+      lucy.lim = lim;
+      pthread_barrier_wait(&lucy.barreira);
+      rodadaParalela(&lucy, 0);
+    }
+    else {
+      // Em ordem crescente de i, gde[i·p] (i·p > i) ainda tem o valor antigo quando é lido
+      for (long long int i = 1; i <= lim; i += 2)
+        lucy.gde[i] -= valorDividido(&lucy, i, p) - sp;
+    }
+
+    // Valores pequenos, em ordem decrescente (peq[v/p] ainda antigo); as leituras da rodada paralela já terminaram
+    for (long long int v = lucy.r; v >= p2; v--)
+      lucy.peq[v] -= lucy.peq[v / p] - sp;
+
+    if (lucy.nThreads > 1 && lim / 2 >= MIN_PARALELO)
+      pthread_barrier_wait(&lucy.barreira);
+  }
+
+  // Encerra as auxiliares
+  lucy.p = 0;
+  if (lucy.nThreads > 1)
+    pthread_barrier_wait(&lucy.barreira);
+  for (int t = 1; t < lucy.nThreads; t++)
+    pthread_join(tids[t], NULL);
+  pthread_barrier_destroy(&lucy.barreira);
+  sem_destroy(&lucy.largada);
+
+  pi = lucy.gde[1];
+  free(lucy.peq);
+  free(lucy.gde);
+  free(lucy.novo);
+
+  return pi;
+}
\ No newline at end of file
@@ -0,0 +1,14 @@
+// Contagem de primos π(x) sublinear pelo método de Lucy_Hedgehog, em O(x^{3/4})
+//
+// Mantém S(v) = quantidade de inteiros em [2, v] que sobrevivem ao crivo pelos primos já processados, só para
+// os O(√x) valores v = x/i que aparecem na recorrência S(v) -= S(v/p) - S(p-1). Ao final, S(x) = π(x).
+// O primo 2 é resolvido na inicialização, e dos valores grandes só os de i ímpar são mantidos.
+// As atualizações de cada primo p sobre os valores grandes são independentes entre si e são divididas entre
+// as threads (enquanto forem muitas); os primos maiores, com poucas atualizações, seguem sequenciais.
+
+#pragma once
+
+// Devolve π(x), a quantidade de primos em [1, x], usando `nThreads` threads (1 roda na própria chamadora),
+// ou -1 se não foi possível alocar memória. `nThreads` é limitado a ⌊√x⌋/2^15 (as rodadas menores não são
+// divididas) e a 256
+long long int piLucy(long long int x, int nThreads);
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include <stdint.h>
+#include "millerRabin.h"
+
+typedef unsigned __int128 u128;
+
+// Primos pequenos usados como pré-filtro (todo n < 59² que passa por eles é primo)
+static const uint32_t primosPequenos[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53};
+#define NPEQUENOS ((int)(sizeof(primosPequenos) / sizeof(primosPequenos[0])))
+#define LIMITE_PEQUENOS (59ULL * 59ULL) // Menor composto sem fator entre os primos pequenos
+
+// Testemunhas que tornam o teste determinístico para n < 2^64 (Jim Sinclair)
+static const uint64_t testemunhas[] = {2, 325, 9375, 28178, 450775, 9780504, 1795265022};
+#define NTESTEMUNHAS ((int)(sizeof(testemunhas) / sizeof(testemunhas[0])))
+
+// Módulo ímpar em aritmética de Montgomery (R = 2^64)
+typedef struct {
+  uint64_t n;
+  uint64_t nInv; // n⁻¹ mod 2^64
+  uint64_t r2; // R² mod n (converte para a forma de Montgomery)
+  uint64_t um; // R mod n (1 na forma de Montgomery)
+} t_montgomery;
+
+// Redução de Montgomery: devolve t·R⁻¹ mod n (para t < n·R), sem estourar mesmo com n >= 2^63
+static inline uint64_t redc(const t_montgomery* m, u128 t){
+  uint64_t q = (uint64_t)t * m->nInv; // Partes baixas de t e q·n coincidem
+  uint64_t alto = (uint64_t)(((u128)q * m->n) >> 64);
+  uint64_t tAlto = (uint64_t)(t >> 64);
+
+  return tAlto >= alto ? tAlto - alto : tAlto - alto + m->n;
+}
+
+static inline uint64_t multMont(const t_montgomery* m, uint64_t a, uint64_t b){
+  return redc(m, (u128)a * b);
+}
+
+static void iniciaMont(t_montgomery* m, uint64_t n){
+  uint64_t inv = n; // Correto em 3 bits para n ímpar; cada passo de Newton dobra os bits corretos
+
+  for (int i = 0; i < 5; i++)
+    inv *= 2 - n * inv;
+
+  m->n = n;
+  m->nInv = inv;
+  m->um = (uint64_t)(-n) % n; // 2^64 mod n
+  m->r2 = (uint64_t)((u128)m->um * m->um % n);
+}
+
+// Uma rodada de Miller–Rabin com a testemunha `a` (n - 1 = d·2^s, d ímpar); devolve 0 se provou que n é composto
+static int rodada(const t_montgomery* m, uint64_t a, uint64_t d, int s){
+  uint64_t menosUm = m->n - m->um; // -1 na forma de Montgomery
+  uint64_t base = multMont(m, a % m->n, m->r2);
+  uint64_t x = m->um;
+
+  if (base == 0)
+    return 1; // a ≡ 0 (mod n): a testemunha não diz nada
+
+  // x = a^d
+  for (; d; d >>= 1){
+    if (d & 1)
+      x = multMont(m, x, base);
+    base = multMont(m, base, base);
+  }
+
+  if (x == m->um || x == menosUm)
+    return 1;
+  for (int i = 1; i < s; i++){
+    x = multMont(m, x, x);
+    if (x == menosUm)
+      return 1;
+  }
+
+  return 0;
+}
+
+int ehPrimoMR64(unsigned long long int n){
+  t_montgomery m;
+  uint64_t d = n - 1;
+  int s = 0;
+
+  if (n < 2)
+    return 0;
+
+  // Pré-filtro: divisão pelos primos pequenos
+  for (int i = 0; i < NPEQUENOS; i++)
+    if (n % primosPequenos[i] == 0)
+      return n == primosPequenos[i];
+  if (n < LIMITE_PEQUENOS)
+    return 1;
+
+  while (!(d & 1)){
+    d >>= 1;
+    s++;
+  }
+
+  iniciaMont(&m, n);
+  for (int i = 0; i < NTESTEMUNHAS; i++)
+    if (!rodada(&m, testemunhas[i], d, s))
+      return 0;
+
+  return 1;
+}
+
+int ehPrimoMR(long long int n){
+  return n < 2 ? 0 : ehPrimoMR64((unsigned long long int)n);
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+// Teste de primalidade de Miller–Rabin determinístico para inteiros de 64 bits
+//
+// Usa a base de testemunhas {2, 325, 9375, 28178, 450775, 9780504, 1795265022}, que dá a resposta exata
+// para todo n < 2^64, com multiplicação de Montgomery em `unsigned __int128` (sem divisões no laço).
+// Antes, a divisão pelos primos pequenos descarta a maior parte dos compostos com custo mínimo.
+
+#pragma once
+
+// Devolve 1 se `n` é primo e 0 caso contrário (qualquer `long long int`; negativos não são primos)
+int ehPrimoMR(long long int n);
+
+// O mesmo, para todo o intervalo sem sinal de 64 bits
+int ehPrimoMR64(unsigned long long int n);
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "roda.h"
+
+#define CAPACIDADE_TABELA 1300000 // Cota superior de π(RODA_LIMITE_TABELA) (1,26·x/ln x)
+
+// Distância de cada resíduo r (mod 210) até o próximo resíduo coprimo com 210, estritamente maior que r
+static const unsigned char passo[210] = {
+  1, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 2, 1, 4, 3, 2, 1, 2, 1, 4, 3, 2, 1, 6, 5, 4, 3, 2, 1, 2, 1, 6, 5,
+  4, 3, 2, 1, 4, 3, 2, 1, 2, 1, 4, 3, 2, 1, 6, 5, 4, 3, 2, 1, 6, 5, 4, 3, 2, 1, 2, 1, 6, 5, 4, 3, 2,
+  1, 4, 3, 2, 1, 2, 1, 6, 5, 4, 3, 2, 1, 4, 3, 2, 1, 6, 5, 4, 3, 2, 1, 8, 7, 6, 5, 4, 3, 2, 1, 4, 3,
+  2, 1, 2, 1, 4, 3, 2, 1, 2, 1, 4, 3, 2, 1, 8, 7, 6, 5, 4, 3, 2, 1, 6, 5, 4, 3, 2, 1, 4, 3, 2, 1, 6,
+  5, 4, 3, 2, 1, 2, 1, 4, 3, 2, 1, 6, 5, 4, 3, 2, 1, 2, 1, 6, 5, 4, 3, 2, 1, 6, 5, 4, 3, 2, 1, 4, 3,
+  2, 1, 2, 1, 4, 3, 2, 1, 6, 5, 4, 3, 2, 1, 2, 1, 6, 5, 4, 3, 2, 1, 4, 3, 2, 1, 2, 1, 4, 3, 2, 1, 2,
+  1, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 2
+};
+
+// Tabela de primos a partir de 11: as entradas [0, nTabela) estão prontas e nunca mudam,
+// então as leitoras só precisam de um load com acquire de `nTabela`
+static uint32_t* tabela;
+static atomic_long nTabela;
+static long long int limiteTabela = 10; // Todos os primos até aqui estão na tabela (protegido por `travaTabela`)
+static pthread_mutex_t travaTabela = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t tabelaCriada = PTHREAD_ONCE_INIT;
+
+static void criaTabela(){
+  tabela = (uint32_t*)malloc(CAPACIDADE_TABELA * sizeof(uint32_t)); // Páginas só são tocadas quando usadas
+  atomic_init(&nTabela, 0);
+}
+
+long long int rodaProximo(long long int n){
+  if (n < 7)
+    return n < 1 ? 1 : n < 2 ? 2 : n < 3 ? 3 : n < 5 ? 5 : 7;
+  return n + passo[n % 210];
+}
+
+long long int rodaAnterior(long long int n){
+  if (n < 11)
+    return n < 1 ? 0 : n < 2 ? 1 : n < 3 ? 2 : n < 5 ? 3 : n < 7 ? 5 : 7;
+  while (!(n % 2 && n % 3 && n % 5 && n % 7))
+    n--;
+  return n;
+}
+
+// Acrescenta à tabela os primos de (limiteTabela, novo] com um crivo do intervalo (chamada com a trava)
+static void estendeTabela(long long int novo){
+  long long int inicio = limiteTabela + 1;
+  long n = atomic_load_explicit(&nTabela, memory_order_relaxed);
+  char* composto = (char*)calloc(novo - limiteTabela, 1);
+
+  if (!composto)
+    return;
+
+  // Os primos até √novo já estão na tabela (ou são 2, 3, 5 e 7), pois novo <= limiteTabela²
+  for (long i = -4; i < n; i++){
+    long long int p = i < 0 ? (long long int[]){2, 3, 5, 7}[i + 4] : tabela[i];
+    long long int j = (inicio + p - 1) / p * p;
+
+    if (p * p > novo)
+      break;
+    if (j < p * p)
+      j = p * p;
+    for (; j <= novo; j += p)
+      composto[j - inicio] = 1;
+  }
+
+  for (long long int k = inicio; k <= novo && n < CAPACIDADE_TABELA; k++)
+    if (!composto[k - inicio])
+      tabela[n++] = (uint32_t)k;
+
+  free(composto);
+  limiteTabela = novo;
+  atomic_store_explicit(&nTabela, n, memory_order_release); // Publica as entradas novas
+}
+
+// Garante que a tabela tenha todos os primos até `lim` (ou até RODA_LIMITE_TABELA)
+static void garanteTabela(long long int lim){
+  static atomic_llong limitePublicado = 10; // Cópia de `limiteTabela` para a verificação sem trava
+
+  if (lim > RODA_LIMITE_TABELA)
+    lim = RODA_LIMITE_TABELA;
+  if (lim <= atomic_load_explicit(&limitePublicado, memory_order_acquire))
+    return;
+
+  pthread_once(&tabelaCriada, criaTabela);
+  if (!tabela)
+    return;
+
+  pthread_mutex_lock(&travaTabela);
+  while (limiteTabela < lim){
+    // Dobra o limite (no mínimo até `lim`), sem passar de limiteTabela² nem do máximo da tabela
+    long long int novo = 2 * limiteTabela > lim ? 2 * limiteTabela : lim;
+    long long int antes = limiteTabela;
+
+    if (novo > limiteTabela * limiteTabela)
+      novo = limiteTabela * limiteTabela;
+    if (novo > RODA_LIMITE_TABELA)
+      novo = RODA_LIMITE_TABELA;
+    estendeTabela(novo);
+    if (limiteTabela == antes)
+      break; // Sem memória para o crivo do intervalo: segue com a tabela atual
+  }
+  atomic_store_explicit(&limitePublicado, limiteTabela, memory_order_release);
+  pthread_mutex_unlock(&travaTabela);
+}
+
+int ehPrimoRoda(long long int n){
+  long long int raiz, d;
+  long cnt;
+
+  if (n < 2)
+    return 0;
+  if (n % 2 == 0 || n % 3 == 0 || n % 5 == 0 || n % 7 == 0)
+    return n == 2 || n == 3 || n == 5 || n == 7;
+  if (n < 121)
+    return 1;
+
+  // Raiz inteira por Newton, partindo de uma potência de 2 acima dela (poucas iterações)
+  raiz = 1LL << ((64 - __builtin_clzll(n) + 1) / 2);
+  for (d = (raiz + n / raiz) / 2; d < raiz; d = (raiz + n / raiz) / 2)
+    raiz = d;
+
+  garanteTabela(raiz);
+  cnt = tabela ? atomic_load_explicit(&nTabela, memory_order_acquire) : 0;
+
+  // Divide pelos primos da tabela...
+  for (long i = 0; i < cnt; i++){
+    uint32_t p = tabela[i];
+    if (p > raiz)
+      return 1;
+    if (n % p == 0)
+      return 0;
+  }
+
+  // ... e, além dela, pelos candidatos da roda
+  for (d = rodaProximo(cnt ? tabela[cnt - 1] : 7); d <= raiz; d = rodaProximo(d))
+    if (n % d == 0)
+      return 0;
+
+  return 1;
+}
\ No newline at end of file
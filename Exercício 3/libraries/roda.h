@@ -0,0 +1,19 @@
+// Divisão por tentativa com roda 2·3·5·7 e tabela de primos compartilhada
+//
+// Candidatos são o 1, os primos 2, 3, 5 e 7 e os inteiros coprimos com 210 (48 de cada 210, ~23%):
+// os demais são múltiplos de 2, 3, 5 ou 7 e nem precisam ser testados. Os divisores testados são só os
+// primos de uma tabela compartilhada, estendida sob demanda (até RODA_LIMITE_TABELA) por qualquer thread
+// e lida sem trava; acima dela, os divisores seguem a roda.
+
+#pragma once
+
+#define RODA_LIMITE_TABELA (1LL << 24) // Maior divisor guardado na tabela (cobre todo n < 2^48)
+
+// Devolve 1 se `n` é primo e 0 caso contrário
+int ehPrimoRoda(long long int n);
+
+// Devolve o menor candidato da roda maior que `n` (para `n` >= 0)
+long long int rodaProximo(long long int n);
+
+// Devolve o maior candidato da roda menor ou igual a `n`, ou 0 se não houver
+long long int rodaAnterior(long long int n);
\ No newline at end of file